@@ -1,7 +1,12 @@
 #include "Audio.hpp"
 #include "AudioFactory.hpp"
+#include "Kernels.hpp"
+#include "SampleBuffer.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
 
-Audio::Audio() : sampleRate(0.0f), duration(0.0), sampleSize(0) {
+Audio::Audio() : sampleRate(0.0f), duration(0.0), sampleSize(0), channels(1) {
 
 }
 
@@ -17,6 +22,10 @@ size_t Audio::getSampleSize() const {
     return this->sampleSize;
 }
 
+unsigned Audio::getChannels() const {
+    return this->channels;
+}
+
 void Audio::print() const {
     std::cout << this->duration << '\n';
     std::cout << this->sampleRate << '\n';
@@ -24,6 +33,88 @@ void Audio::print() const {
 }
 
 
+void Audio::render(std::size_t start, std::size_t count, sample *const *out) const {
+    for (std::size_t i = 0; i < count; ++i) {
+        out[0][i] = (start + i < this->sampleSize) ? (*this)[start + i] : sample(0);
+    }
+    for (unsigned c = 1; c < this->channels; ++c) {
+        std::copy(out[0], out[0] + count, out[c]);
+    }
+}
+
+AudioRegion Audio::describeRegion(std::size_t start, std::size_t /*count*/) const {
+    AudioRegion region;
+    region.constant = start >= this->getSampleSize();
+    return region;
+}
+
+/// Samples per parallel analysis chunk; large enough to amortize task overhead
+static constexpr std::size_t analysisGrain = 64 * Audio::blockSize;
+
+// Level totals of one analysis chunk
+struct ChunkLevels {
+    double peak = 0.0;
+    double sumSquares = 0.0;
+};
+
+// Combines per-chunk totals in chunk order, so the result does not depend on scheduling
+static AudioStats reduceLevels(const std::vector<ChunkLevels> &chunks, std::size_t count) {
+    AudioStats total;
+    double sumSquares = 0.0;
+    for (const ChunkLevels &chunk : chunks) {
+        total.peak = std::max(total.peak, chunk.peak);
+        sumSquares += chunk.sumSquares;
+    }
+    total.rms = count > 0 ? std::sqrt(sumSquares / static_cast<double>(count)) : 0.0; // count covers all channels
+    return total;
+}
+
+AudioStats Audio::analyze() const {
+    std::size_t size = this->getSampleSize();
+    std::vector<ChunkLevels> chunks((size + analysisGrain - 1) / analysisGrain);
+    ThreadPool::getInstance().parallelFor(0, size, analysisGrain, [&](std::size_t begin, std::size_t end) {
+        const KernelSet &kernels = activeKernels();
+        PlanarBlock block(this->channels);
+        ChunkLevels &chunk = chunks[begin / analysisGrain];
+        for (std::size_t pos = begin; pos < end; pos += Audio::blockSize) {
+            std::size_t count = std::min(Audio::blockSize, end - pos);
+            AudioRegion region = this->describeRegion(pos, count);
+            if (region.constant) { // Constant blocks contribute without being rendered
+                chunk.peak = std::max<double>(chunk.peak, std::fabs(region.value));
+                chunk.sumSquares += static_cast<double>(region.value) * region.value * count * this->channels;
+                continue;
+            }
+            this->render(pos, count, block.planes());
+            for (unsigned c = 0; c < this->channels; ++c) {
+                chunk.peak = std::max<double>(chunk.peak, kernels.peak(block[c], count));
+                chunk.sumSquares += kernels.sumSquares(block[c], count);
+            }
+        }
+    });
+    return reduceLevels(chunks, size * this->channels);
+}
+
+bool Audio::isRandomAccess() const {
+    return true;
+}
+
+bool Audio::getSource(AudioSource & /*source*/) const {
+    return false;
+}
+
+AudioStats Audio::scanSamples(const sample *const *planes, unsigned channels, std::size_t count) {
+    std::vector<ChunkLevels> chunks((count + analysisGrain - 1) / analysisGrain);
+    ThreadPool::getInstance().parallelFor(0, count, analysisGrain, [&](std::size_t begin, std::size_t end) {
+        const KernelSet &kernels = activeKernels();
+        ChunkLevels &chunk = chunks[begin / analysisGrain];
+        for (unsigned c = 0; c < channels; ++c) {
+            chunk.peak = std::max<double>(chunk.peak, kernels.peak(planes[c] + begin, end - begin));
+            chunk.sumSquares += kernels.sumSquares(planes[c] + begin, end - begin);
+        }
+    });
+    return reduceLevels(chunks, count * channels);
+}
+
 void Audio::setDuration(double duration) {
     if (!isValidDuration(duration)) {
         throw std::invalid_argument("Invalid Duration");
@@ -45,6 +136,13 @@ void Audio::setSampleSize(size_t size) {
     this->sampleSize = size;
 }
 
+void Audio::setChannels(unsigned count) {
+    if (count == 0) {
+        throw std::invalid_argument("Invalid Channel Count");
+    }
+    this->channels = count;
+}
+
 bool Audio::isValidSampleRate(float rate) {
     return rate > 0;
 }
@@ -62,6 +160,18 @@ bool AudioCreator::supportsAudio(const std::string &cmd) const {
     return this->createCommand == cmd;
 }
 
-AudioCreator::AudioCreator(const char *command) : createCommand(command) {
+bool AudioCreator::readParameters(std::istream & /*in*/, std::string & /*parameters*/) const {
+    return false;
+}
+
+std::string AudioCreator::getVersion(const std::string & /*parameters*/) const {
+    return "";
+}
+
+std::uint32_t AudioCreator::getCommandCode() const {
+    return this->code;
+}
+
+AudioCreator::AudioCreator(const char *command) : createCommand(command), code(commandCode(command)) {
     AudioFactory::getInstance().registerAudio(this);
 }
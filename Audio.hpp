@@ -7,14 +7,54 @@
 #define DAW_AUDIO_HPP
 #pragma once
 
-using sample = double;
+#ifdef DAW_SAMPLE_FLOAT
+using sample = float;  ///< Sample type for storage and processing, selected with the DAW_FLOAT_SAMPLES build option.
+#else
+using sample = double; ///< Sample type for storage and processing, selected with the DAW_FLOAT_SAMPLES build option.
+#endif
 
+#include <cstdint>
 #include <vector>
 #include <fstream>
 #include <iostream>
 #include <string>
 #include <sstream>
 
+/**
+ * @brief Level statistics of an audio signal.
+ */
+struct AudioStats {
+    double peak = 0.0; ///< The largest absolute sample value.
+    double rms = 0.0;  ///< The root mean square of all samples.
+};
+
+/**
+ * @brief What is known about a range of samples without rendering it.
+ *
+ * Sources report constant (usually silent) ranges so that effects, bounces and writers
+ * can fill or skip them instead of rendering and processing every sample.
+ */
+struct AudioRegion {
+    bool constant = false; ///< True if every sample of every channel in the range equals `value`.
+    sample value = 0;      ///< The value of the range, if `constant` is set.
+
+    /**
+     * @brief Checks whether the range is known to be silent.
+     * @return True if the range is constant zero.
+     */
+    bool isSilent() const {
+        return constant && value == 0;
+    }
+};
+
+/**
+ * @brief How to recreate an audio object through the `AudioFactory`.
+ */
+struct AudioSource {
+    std::string command; ///< The full factory command, e.g. "CLIP take1.clip".
+    std::string path;    ///< The file the command reads, or empty if it reads none.
+};
+
 /**
  * @brief Abstract base class for Audio objects.
  *
@@ -22,14 +62,28 @@ using sample = double;
  * It defines pure virtual functions for accessing and manipulating audio samples.
  */
 class Audio {
+public:
+    /// @brief The preferred number of samples per `render()` call for block-wise consumers.
+    static constexpr std::size_t blockSize = 4096;
+
 protected:
 //    std::vector<double> samples;
 //    TODO string name
     float sampleRate; ///< The sample rate of the audio in Hz.
     double duration;   ///< The duration of the audio in seconds.
-    size_t sampleSize; ///< The number of samples in the audio.
+    size_t sampleSize; ///< The number of samples in the audio, per channel.
+    unsigned channels; ///< The number of channels; samples are rendered as one plane per channel.
     std::string audioName; ///< The name of the audio.
 
+    /**
+     * @brief Computes level statistics of in-memory sample planes with a parallel, vectorized scan.
+     * @param planes The channel planes to scan.
+     * @param channels The number of planes.
+     * @param count The number of samples per plane.
+     * @return The peak and RMS over all channels.
+     */
+    static AudioStats scanSamples(const sample *const *planes, unsigned channels, std::size_t count);
+
 public:
     /**
      * @brief Default constructor for Audio.
@@ -62,6 +116,12 @@ public:
      */
     void setSampleSize(size_t size);
 
+    /**
+     * @brief Sets the number of channels of the audio.
+     * @param count The new number of channels.
+     */
+    void setChannels(unsigned count);
+
     /**
      * @brief Gets the sample rate of the audio.
      * @return The sample rate in Hz.
@@ -80,6 +140,12 @@ public:
      */
     size_t getSampleSize() const;
 
+    /**
+     * @brief Gets the number of channels of the audio.
+     * @return The number of channels (1 for mono).
+     */
+    unsigned getChannels() const;
+
     /**
      * @brief Checks if a given sample rate is valid.
      * @param rate The sample rate to check.
@@ -115,17 +181,78 @@ public:
 
     /**
      * @brief Gets the audio sample at the given index (const version).
+     *
+     * This is a per-sample compatibility shim that reads the first channel;
+     * bulk consumers should use `render()`.
      * @param index The index of the sample.
      * @return The audio sample at the given index.
      */
-    virtual double operator[](std::size_t index) const = 0 ;
+    virtual sample operator[](std::size_t index) const = 0 ;
+
+    /**
+     * @brief Renders a contiguous block of samples of every channel into caller-provided planes.
+     *
+     * This is the primary bulk access path. The default implementation falls back to
+     * `operator[]` and copies it to every plane; concrete audio types override it with a
+     * native block loop. Indices at or beyond `getSampleSize()` are rendered as silence (0.0).
+     * @param start The index of the first sample to render.
+     * @param count The number of samples to render per channel.
+     * @param out One destination plane per channel (`getChannels()` of them), each with room
+     *            for at least `count` samples.
+     */
+    virtual void render(std::size_t start, std::size_t count, sample *const *out) const;
+
+    /**
+     * @brief Describes a range of samples without rendering it.
+     *
+     * Must be cheap: it is asked once per block by effects, bounces and writers, which then
+     * fill constant ranges instead of calling `render()`. The default knows only that samples
+     * past `getSampleSize()` are silent; sources with constant content override it.
+     * @param start The index of the first sample of the range.
+     * @param count The number of samples in the range.
+     * @return A constant region if every sample in the range has the same value, otherwise an unknown one.
+     */
+    virtual AudioRegion describeRegion(std::size_t start, std::size_t count) const;
 
     /**
      * @brief Gets a reference to the audio sample at the given index.
+     *
+     * This is a per-sample compatibility shim that accesses the first channel.
      * @param index The index of the sample.
      * @return A reference to the audio sample at the given index.
      */
-    virtual double &operator[](std::size_t index) = 0;
+    virtual sample &operator[](std::size_t index) = 0;
+
+    /**
+     * @brief Computes the peak and RMS level of the audio over all channels.
+     *
+     * The default implementation renders the audio in parallel chunks on the shared
+     * `ThreadPool` and scans each block with the vectorized kernels. Sources that keep
+     * their samples in memory override this to cache the result.
+     * @return The level statistics of the audio.
+     */
+    virtual AudioStats analyze() const;
+
+    /**
+     * @brief Checks whether samples can be rendered in any order.
+     *
+     * Sequential sources, such as audio read from a pipe, can only render blocks with
+     * non-decreasing start indices; consumers that split the audio into parallel chunks
+     * must render them in order instead.
+     * @return True if `render()` accepts any start index (the default), false if it must be called in order.
+     */
+    virtual bool isRandomAccess() const;
+
+    /**
+     * @brief Describes how to recreate this audio without storing its samples.
+     *
+     * Sources backed by files, or fully described by a few parameters, return the `AudioFactory`
+     * command that recreates them, so projects can reference them instead of embedding samples.
+     * Files are named by canonical path, so the command works from any working directory.
+     * @param source Receives the command and the file it reads, if any.
+     * @return True if `source` was filled; false (the default) if only the samples describe the audio.
+     */
+    virtual bool getSource(AudioSource &source) const;
 
     /**
      * @brief Creates a clone of the Audio object.
@@ -146,6 +273,8 @@ class AudioCreator {
 protected:
     /// @brief The command string used to identify the type of audio to create.
     std::string createCommand;
+    /// @brief The command packed by `commandCode()`, the key the factory dispatches on.
+    std::uint32_t code;
 
 public:
     /**
@@ -166,6 +295,34 @@ public:
      */
     bool supportsAudio(const std::string &s) const;
 
+    /**
+     * @brief Gets the packed command code of this creator.
+     * @return The value of `commandCode()` for the command.
+     */
+    std::uint32_t getCommandCode() const;
+
+    /**
+     * @brief Reads the parameters of a command without creating the audio.
+     *
+     * Lets `AudioFactory::createShared()` find a live node for the command before doing the
+     * work of creating one. Creators whose parameters are just a file name override this; the
+     * default reads nothing, and the node is keyed by the command text once it is created.
+     * @param in The input stream, positioned after the command.
+     * @param parameters Receives the parameters, whitespace-separated, for `createAudio()` to read.
+     * @return True if the parameters were read; false if this creator does not read them apart.
+     */
+    virtual bool readParameters(std::istream &in, std::string &parameters) const;
+
+    /**
+     * @brief Describes the current state of what parameters read by `readParameters()` refer to.
+     *
+     * Creators reading files return the file's version, so a node made from a file that has
+     * changed since is not reused.
+     * @param parameters The parameters.
+     * @return The state, or an empty string (the default) if the parameters alone describe the audio.
+     */
+    virtual std::string getVersion(const std::string &parameters) const;
+
     /**
      * @brief Creates an Audio object from an input stream.
      * @param in The input stream to read audio data from.
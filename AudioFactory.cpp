@@ -1,5 +1,128 @@
+#include <algorithm>
+#include <cctype>
+#include <iterator>
 #include <limits>
+#include <locale>
+#include <sstream>
 #include "AudioFactory.hpp"
+#include "SharedAudio.hpp"
+#include <streambuf>
+
+std::uint32_t readCommand(std::istream &in) {
+    std::istream::sentry sentry(in); // Skips leading whitespace
+    if (!sentry) {
+        return 0;
+    }
+    std::streambuf *buffer = in.rdbuf();
+    const std::ctype<char> &types = std::use_facet<std::ctype<char>>(in.getloc());
+    std::uint32_t code = 0;
+    std::size_t length = 0;
+    std::istream::int_type c = buffer->sgetc();
+    while (c != std::istream::traits_type::eof() && !types.is(std::ctype_base::space, static_cast<char>(c))) {
+        code = (code << 8) | static_cast<unsigned char>(c);
+        ++length;
+        c = buffer->snextc();
+    }
+    if (c == std::istream::traits_type::eof()) {
+        in.setstate(std::ios::eofbit);
+    }
+    if (length == 0) {
+        in.setstate(std::ios::failbit);
+    }
+    return (length > 4) ? 0 : code;
+}
+
+std::string commandName(std::uint32_t code) {
+    std::string name;
+    for (; code != 0; code >>= 8) {
+        name.insert(name.begin(), static_cast<char>(code & 0xFF));
+    }
+    return name;
+}
+
+namespace {
+
+/**
+ * @brief A stream buffer that forwards another one a character at a time and keeps what it read.
+ *
+ * Reading one character ahead at most means a parse consumes from the real stream only what it
+ * used, plus one character that `release()` puts back.
+ */
+class CommandRecorder : public std::streambuf {
+private:
+    std::streambuf *source; ///< The stream buffer read from.
+    std::string text;       ///< Everything read so far.
+    char current = 0;       ///< The character in the get area.
+
+protected:
+    int_type underflow() override {
+        int_type c = this->source->sbumpc();
+        if (traits_type::eq_int_type(c, traits_type::eof())) {
+            return c;
+        }
+        this->current = traits_type::to_char_type(c);
+        this->text.push_back(this->current);
+        this->setg(&this->current, &this->current, &this->current + 1);
+        return c;
+    }
+
+public:
+    explicit CommandRecorder(std::streambuf *source) : source(source) {}
+
+    /**
+     * @brief Gets the number of characters consumed so far.
+     * @return The length of the recorded text, less a character read ahead but not consumed.
+     */
+    std::size_t consumed() const {
+        return this->text.size() - static_cast<std::size_t>(this->egptr() - this->gptr());
+    }
+
+    /**
+     * @brief Gets consumed text with whitespace runs collapsed to single spaces and trimmed.
+     * @param from The first character.
+     * @param to One past the last character.
+     * @return The normalized text.
+     */
+    std::string normalized(std::size_t from, std::size_t to) const {
+        std::string key;
+        bool space = false;
+        for (std::size_t i = from; i < to; ++i) {
+            if (std::isspace(static_cast<unsigned char>(this->text[i]))) {
+                space = !key.empty();
+                continue;
+            }
+            if (space) {
+                key.push_back(' ');
+                space = false;
+            }
+            key.push_back(this->text[i]);
+        }
+        return key;
+    }
+
+    /**
+     * @brief Returns a character read ahead but not consumed to the source.
+     */
+    void release() {
+        if (this->gptr() < this->egptr()) {
+            this->source->sungetc();
+            this->setg(nullptr, nullptr, nullptr);
+        }
+    }
+};
+
+/**
+ * @brief The recording stream of the createShared() call running on this thread, if any.
+ */
+struct Recording {
+    CommandRecorder *recorder; ///< The recorder.
+    std::istream *stream;      ///< The stream reading through it, passed down to creators.
+    std::string versions;      ///< The versions of the files read so far, each after a newline.
+};
+
+thread_local Recording *activeRecording = nullptr;
+
+} // namespace
 
 AudioFactory::AudioFactory() {
     std::clog << "Created Audio factory" << std::endl;
@@ -11,14 +134,12 @@ AudioFactory &AudioFactory::getInstance() {
 }
 
 void AudioFactory::registerAudio(const AudioCreator *creator) {
-    creators.push_back(creator);
-    size++;
+    creators[creator->getCommandCode()] = creator;
 }
 
 Audio *AudioFactory::createAudio(std::istream &input) {
-    std::string command;
-    input >> command;
-    const AudioCreator *creator = getCreator(command);
+    std::uint32_t code = readCommand(input);
+    const AudioCreator *creator = getCreator(code);
     if (creator) {
         return creator->createAudio(input);
     } else {
@@ -28,15 +149,132 @@ Audio *AudioFactory::createAudio(std::istream &input) {
     }
 }
 
-const AudioCreator *AudioFactory::getCreator(const std::string &str) const {
-    for (int i = 0; i < size; ++i) {
-        if (creators[i]->supportsAudio(str))
-            return creators[i];
+const AudioCreator *AudioFactory::getCreator(std::uint32_t code) const {
+    auto found = creators.find(code);
+    return (found != creators.end()) ? found->second : nullptr;
+}
+
+std::shared_ptr<const Audio> AudioFactory::createInterned(std::istream &input) {
+    Recording &recording = *activeRecording;
+    CommandRecorder &recorder = *recording.recorder;
+    std::size_t from = recorder.consumed();
+    std::size_t versionsFrom = recording.versions.size();
+    std::uint32_t code = readCommand(input);
+    const AudioCreator *creator = this->getCreator(code);
+    if (!creator) {
+        input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        throw std::runtime_error("Could not find appropriate Audio creator");
+    }
+
+    std::string parameters;
+    if (creator->readParameters(input, parameters)) {
+        std::string version = creator->getVersion(parameters);
+        if (!version.empty()) {
+            // Keys also hold the file's state, and so do the keys of every command built on it,
+            // so nodes made before the file changed are not reused. Newlines never occur in the text
+            recording.versions += '\n' + version;
+        }
+        std::string key = commandName(code) + ' ' + parameters + recording.versions.substr(versionsFrom);
+        return this->createKeyed(*creator, key, parameters);
+    }
+
+    std::shared_ptr<const Audio> created(creator->createAudio(input));
+    if (!created || !created->isRandomAccess()) {
+        return created; // Each consumer of a stream needs its own reader
     }
-    return nullptr;
+    std::string key = recorder.normalized(from, recorder.consumed());
+    return key.empty() ? created : this->intern(key + recording.versions.substr(versionsFrom), std::move(created));
 }
 
+std::shared_ptr<const Audio> AudioFactory::createKeyed(const AudioCreator &creator, const std::string &key,
+                                                       const std::string &parameters) {
+    std::promise<std::shared_ptr<const SharedAudio>> creating;
+    for (;;) {
+        std::unique_lock<std::mutex> lock(this->internMutex);
+        auto found = this->interned.find(key);
+        if (found != this->interned.end()) {
+            if (std::shared_ptr<const SharedAudio> existing = found->second.lock()) {
+                existing->markShared();
+                return existing;
+            }
+        }
+        auto building = this->pending.find(key);
+        if (building == this->pending.end()) {
+            this->pending.emplace(key, creating.get_future().share());
+            break;
+        }
+        std::shared_future<std::shared_ptr<const SharedAudio>> result = building->second;
+        lock.unlock();
+        if (std::shared_ptr<const SharedAudio> shared = result.get()) { // Rethrows the error of a failed creation
+            shared->markShared();
+            return shared;
+        }
+        // The node could not be shared, so create another one
+    }
 
+    try {
+        std::istringstream command(parameters + '\n');
+        std::shared_ptr<const Audio> created(creator.createAudio(command));
+        std::shared_ptr<const SharedAudio> shared;
+        if (created && created->isRandomAccess()) {
+            shared = this->intern(key, std::move(created));
+            created = shared;
+        }
+        {
+            std::lock_guard<std::mutex> lock(this->internMutex);
+            this->pending.erase(key);
+        }
+        creating.set_value(shared);
+        return created;
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(this->internMutex);
+            this->pending.erase(key);
+        }
+        creating.set_exception(std::current_exception());
+        throw;
+    }
+}
 
+std::shared_ptr<const SharedAudio> AudioFactory::intern(const std::string &key, std::shared_ptr<const Audio> created) {
+    std::lock_guard<std::mutex> lock(this->internMutex);
+    std::weak_ptr<const SharedAudio> &entry = this->interned[key];
+    if (std::shared_ptr<const SharedAudio> existing = entry.lock()) {
+        existing->markShared(); // Built concurrently or earlier; drop ours
+        return existing;
+    }
+    auto shared = std::make_shared<const SharedAudio>(std::move(created));
+    entry = shared;
+    if (this->interned.size() >= this->sweepAt) {
+        for (auto it = this->interned.begin(); it != this->interned.end();) {
+            it = it->second.expired() ? this->interned.erase(it) : std::next(it);
+        }
+        this->sweepAt = std::max<std::size_t>(64, 2 * this->interned.size());
+    }
+    return shared;
+}
 
+std::shared_ptr<const Audio> AudioFactory::createShared(std::istream &input) {
+    if (activeRecording && activeRecording->stream == &input) {
+        return this->createInterned(input); // A sub-graph of the command being built
+    }
 
+    CommandRecorder recorder(input.rdbuf());
+    std::istream recorded(&recorder);
+    recorded.flags(input.flags());
+    Recording recording{&recorder, &recorded, {}};
+    Recording *outer = activeRecording;
+    activeRecording = &recording;
+    try {
+        std::shared_ptr<const Audio> created = this->createInterned(recorded);
+        activeRecording = outer;
+        recorder.release();
+        input.setstate(recorded.rdstate());
+        return created;
+    } catch (...) {
+        activeRecording = outer;
+        recorder.release();
+        input.setstate(recorded.rdstate());
+        throw;
+    }
+}
@@ -7,6 +7,51 @@
 #define DAW_AUDIOFACTORY_HPP
 
 #include "Audio.hpp"
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+class SharedAudio;
+
+/**
+ * @brief Packs a command of one to four characters into an integer code.
+ *
+ * Commands such as "FILE" or "AMPL" become one 32-bit key, so dispatch hashes an integer
+ * instead of comparing strings.
+ * @param command The command text.
+ * @return The packed code, or 0 if the command is empty or longer than four characters.
+ */
+constexpr std::uint32_t commandCode(const char *command) {
+    std::uint32_t code = 0;
+    std::size_t length = 0;
+    for (; command[length] != '\0'; ++length) {
+        if (length == 4) {
+            return 0;
+        }
+        code = (code << 8) | static_cast<unsigned char>(command[length]);
+    }
+    return code;
+}
+
+/**
+ * @brief Reads the next whitespace-delimited command from a stream and packs it.
+ *
+ * Reads straight from the stream buffer without building a string, so parsing long command
+ * scripts does not allocate per command.
+ * @param in The stream to read from. Sets failbit if no command is left.
+ * @return The packed code, or 0 if there is no command or it is longer than four characters.
+ */
+std::uint32_t readCommand(std::istream &in);
+
+/**
+ * @brief Unpacks a command code for messages.
+ * @param code A code made by `commandCode()`.
+ * @return The command text.
+ */
+std::string commandName(std::uint32_t code);
 
 /**
  * @brief A singleton factory class for creating Audio objects.
@@ -16,17 +61,51 @@
  */
 class AudioFactory {
 private:
-    /// @brief A vector to store registered AudioCreator objects.
-    std::vector<const AudioCreator *> creators;
-    /// @brief The number of registered AudioCreator objects.
-    size_t size;
+    /// @brief The registered AudioCreator objects, keyed by packed command code.
+    std::unordered_map<std::uint32_t, const AudioCreator *> creators;
 
     /**
-     * @brief Gets an appropriate AudioCreator for the given string.
-     * @param str The string identifier for the desired Audio type (e.g., command or file extension).
+     * @brief Gets the AudioCreator for a command.
+     * @param code The packed command code.
      * @return A pointer to the AudioCreator if found, otherwise nullptr.
      */
-    const AudioCreator *getCreator(const std::string &str) const;
+    const AudioCreator *getCreator(std::uint32_t code) const;
+
+    /// @brief The live shared nodes, keyed by their normalized command text and the versions of the files it reads.
+    std::unordered_map<std::string, std::weak_ptr<const SharedAudio>> interned;
+    /// @brief The nodes being created by commands looked up before creation, keyed like `interned`.
+    std::unordered_map<std::string, std::shared_future<std::shared_ptr<const SharedAudio>>> pending;
+    /// @brief The table size at which expired entries are next swept.
+    std::size_t sweepAt = 64;
+    /// @brief Guards `interned`, `pending` and `sweepAt`.
+    std::mutex internMutex;
+
+    /**
+     * @brief Creates a node on a recording stream and interns it under the command text it consumed and the file versions it read.
+     * @param input The recording stream.
+     * @return The shared node.
+     */
+    std::shared_ptr<const Audio> createInterned(std::istream &input);
+
+    /**
+     * @brief Returns the live node for a command whose parameters were read apart, creating it only if there is none.
+     *
+     * A thread asking for a node another thread is creating waits for that node.
+     * @param creator The creator of the command.
+     * @param key The normalized command text, followed by the versions of the files it reads.
+     * @param parameters The parameters read by `AudioCreator::readParameters()`.
+     * @return The node to use.
+     */
+    std::shared_ptr<const Audio> createKeyed(const AudioCreator &creator, const std::string &key,
+                                             const std::string &parameters);
+
+    /**
+     * @brief Returns the live node for a command, or makes a new node the one for it.
+     * @param key The normalized command text, followed by the versions of the files it reads.
+     * @param created The node just created from the command.
+     * @return The node to use.
+     */
+    std::shared_ptr<const SharedAudio> intern(const std::string &key, std::shared_ptr<const Audio> created);
 
     /**
      * @brief Private constructor to enforce singleton pattern.
@@ -53,6 +132,8 @@ public:
 
     /**
      * @brief Registers an AudioCreator with the factory.
+     *
+     * A later creator for the same command replaces the earlier one.
      * @param creator A pointer to the AudioCreator object to register.
      */
     void registerAudio(const AudioCreator *creator);
@@ -67,6 +148,25 @@ public:
      */
     Audio *createAudio(std::istream &input);
 
+    /**
+     * @brief Creates a shared, immutable Audio object from an input stream, hash-consing the graph.
+     *
+     * Every node built along the way is keyed by its command text with the whitespace normalized,
+     * that is by its command, parameters and sub-commands. While a node is alive, building the same
+     * command again, as a sub-graph or a whole graph, returns that node instead of a new one, so a
+     * source used by many effects is loaded once. Keys include the size and modification time of
+     * the files a command reads, so commands over a file that changed get new nodes while
+     * consumers of the old ones keep them. Commands that only name a file are looked up
+     * before the file is loaded, using `AudioCreator::readParameters()`, so concurrent and later
+     * requests for a live file never load it again. Shared nodes are wrapped in a `SharedAudio`,
+     * so once a node has a second consumer, consumers rendering the same block evaluate the
+     * sub-graph once. Nodes that are not random access, such as streams, are never shared.
+     * @param input The input stream to read the command from.
+     * @return The shared node.
+     * @throws std::runtime_error if the command cannot be parsed.
+     */
+    std::shared_ptr<const Audio> createShared(std::istream &input);
+
 };
 
 
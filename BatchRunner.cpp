@@ -0,0 +1,140 @@
+#include "BatchRunner.hpp"
+#include "AudioFactory.hpp"
+#include "ClipAudio.hpp"
+#include "SampleCache.hpp"
+#include "StreamRender.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+BatchRunner::BatchRunner(WavEncoding encoding, unsigned bitsPerSample, WavDither dither)
+        : encoding(encoding), bitsPerSample(bitsPerSample), dither(dither) {}
+
+std::vector<BatchJob> BatchRunner::parseScript(std::istream &in) {
+    std::vector<BatchJob> jobs;
+    std::string text;
+    for (std::size_t line = 1; std::getline(in, text); ++line) {
+        std::size_t first = text.find_first_not_of(" \t\r");
+        if (first == std::string::npos || text[first] == '#') {
+            continue;
+        }
+        std::size_t outputEnd = text.find_first_of(" \t\r", first);
+        std::size_t commandStart = (outputEnd == std::string::npos) ? std::string::npos
+                                                                     : text.find_first_not_of(" \t\r", outputEnd);
+        if (commandStart == std::string::npos) {
+            throw std::runtime_error("Batch script line " + std::to_string(line) + " has no command");
+        }
+        BatchJob job;
+        job.line = line;
+        job.output = text.substr(first, outputEnd - first);
+        job.command = text.substr(commandStart);
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
+
+static bool isClipName(const std::string &name) {
+    static const std::string extension = ".clip";
+    return name.size() > extension.size()
+           && name.compare(name.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+BatchResult BatchRunner::runJob(const BatchJob &job) const {
+    BatchResult result;
+    bool created = false; // Set once the output exists, so failures never delete files the job did not write
+    auto started = std::chrono::steady_clock::now();
+    try {
+        // Creators read up to the end of the line, so give them one
+        std::istringstream command(job.command + "\n");
+        // Shared, so concurrent jobs over the same source load it once
+        std::shared_ptr<const Audio> audio = AudioFactory::getInstance().createShared(command);
+        if (!audio) {
+            throw std::runtime_error("Could not create audio");
+        }
+        if (isClipName(job.output)) {
+            created = true;
+            result.frames = writeClip(*audio, job.output.c_str(),
+                                      this->encoding == WavEncoding::Float ? 4 : sizeof(sample)).frames;
+        } else {
+            std::ofstream out(job.output, std::ios::binary);
+            if (!out.is_open()) {
+                throw std::runtime_error("Failed to open file for writing: " + job.output);
+            }
+            created = true;
+            result.frames = streamToWav(*audio, out, this->encoding, this->bitsPerSample, this->dither);
+            out.close();
+            if (!out) {
+                throw std::runtime_error("Failed to write " + job.output);
+            }
+        }
+        result.audioSeconds = static_cast<double>(result.frames) / audio->getSampleRate();
+        result.succeeded = true;
+    } catch (const std::exception &e) {
+        result.error = e.what();
+    } catch (...) {
+        result.error = "Unknown error";
+    }
+    if (!result.succeeded && created) {
+        std::remove(job.output.c_str()); // Never leave a truncated output behind
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return result;
+}
+
+std::vector<BatchResult> BatchRunner::run(const std::vector<BatchJob> &jobs, std::ostream *report) {
+    std::vector<BatchResult> results(jobs.size());
+    auto started = std::chrono::steady_clock::now();
+    // One job per chunk: jobs vary wildly in length, so idle threads should take the next one
+    ThreadPool::getInstance().parallelFor(0, jobs.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            results[i] = this->runJob(jobs[i]);
+            if (!report) {
+                continue;
+            }
+            std::ostringstream line;
+            line << std::fixed << std::setprecision(3);
+            const BatchResult &result = results[i];
+            if (result.succeeded) {
+                double seconds = std::max(result.seconds, 1e-9);
+                line << "[ok] line " << jobs[i].line << " " << jobs[i].output << ": " << result.frames
+                     << " frames (" << result.audioSeconds << " s) in " << result.seconds << " s, "
+                     << static_cast<double>(result.frames) / seconds / 1e6 << " Mframes/s, "
+                     << std::setprecision(1) << result.audioSeconds / seconds << "x realtime\n";
+            } else {
+                line << "[failed] line " << jobs[i].line << " " << jobs[i].output << ": " << result.error << "\n";
+            }
+            std::lock_guard<std::mutex> lock(this->reportMutex);
+            *report << line.str() << std::flush;
+        }
+    });
+
+    if (report) {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        std::size_t failed = 0;
+        std::uint64_t frames = 0;
+        double audioSeconds = 0;
+        for (const BatchResult &result : results) {
+            failed += result.succeeded ? 0 : 1;
+            frames += result.frames;
+            audioSeconds += result.audioSeconds;
+        }
+        seconds = std::max(seconds, 1e-9);
+        std::ostringstream summary;
+        summary << std::fixed << std::setprecision(3) << "Batch: " << jobs.size() << " jobs, " << failed
+                << " failed, " << frames << " frames (" << audioSeconds << " s) in " << seconds << " s, "
+                << jobs.size() / seconds << " jobs/s, " << static_cast<double>(frames) / seconds / 1e6
+                << " Mframes/s, " << std::setprecision(1) << audioSeconds / seconds << "x realtime\n";
+        SampleCacheStats cache = SampleCache::getInstance().getStats();
+        summary << "Sample cache: " << cache.hits << " hits, " << cache.misses << " misses, " << cache.evictions
+                << " evictions, " << cache.entries << " files, " << (cache.bytes >> 20) << " of "
+                << (cache.budget >> 20) << " MiB\n";
+        *report << summary.str() << std::flush;
+    }
+    return results;
+}
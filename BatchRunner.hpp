@@ -0,0 +1,86 @@
+/**
+ * @file BatchRunner.hpp
+ * @brief Defines the BatchRunner class, which renders scripts of independent jobs in parallel.
+ */
+
+#ifndef DAW_BATCHRUNNER_HPP
+#define DAW_BATCHRUNNER_HPP
+
+#include "WavWriter.hpp"
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One render job of a batch script.
+ */
+struct BatchJob {
+    std::size_t line = 0; ///< The script line the job came from, for reports.
+    std::string output;   ///< The output path; names ending in ".clip" are written as clips, others as WAV.
+    std::string command;  ///< The `AudioFactory` command that builds the audio to render.
+};
+
+/**
+ * @brief The outcome of one batch job.
+ */
+struct BatchResult {
+    bool succeeded = false;   ///< True if the output was written.
+    std::string error;        ///< The error message if the job failed.
+    std::uint64_t frames = 0; ///< The number of frames written.
+    double audioSeconds = 0;  ///< The duration of the rendered audio.
+    double seconds = 0;       ///< The wall-clock time the job took.
+};
+
+/**
+ * @brief Runs batches of render jobs concurrently on the shared `ThreadPool`.
+ *
+ * A script has one job per line: the output path, then the `AudioFactory` command of the audio
+ * to render, e.g. `out/zap.wav EFCT NORM 0.9 MMAP in/zap.wav`. Blank lines and lines starting
+ * with '#' are skipped. Jobs are independent, so each one runs as its own pool task; a job that
+ * fails is reported and its partial output removed, and the others carry on. Every job reports
+ * its time and throughput as it finishes.
+ */
+class BatchRunner {
+private:
+    WavEncoding encoding;    ///< The encoding of WAV outputs.
+    unsigned bitsPerSample;  ///< The sample width of WAV outputs.
+    WavDither dither;        ///< The rounding mode of PCM outputs.
+    std::mutex reportMutex;  ///< Keeps report lines of concurrent jobs whole.
+
+    /**
+     * @brief Runs one job, catching its errors.
+     * @param job The job.
+     * @return The outcome of the job.
+     */
+    BatchResult runJob(const BatchJob &job) const;
+
+public:
+    /**
+     * @brief Constructs a runner writing WAV outputs in the given format.
+     * @param encoding PCM or float output.
+     * @param bitsPerSample 16, 24 or 32 for PCM; 32 for float. Clip outputs are float when this is float.
+     * @param dither The rounding mode for PCM output.
+     */
+    explicit BatchRunner(WavEncoding encoding = WavEncoding::PCM, unsigned bitsPerSample = 16,
+                         WavDither dither = WavDither::None);
+
+    /**
+     * @brief Reads the jobs of a batch script.
+     * @param in The script.
+     * @return The jobs, in script order.
+     * @throws std::runtime_error if a line has an output path but no command.
+     */
+    static std::vector<BatchJob> parseScript(std::istream &in);
+
+    /**
+     * @brief Runs jobs concurrently.
+     * @param jobs The jobs to run.
+     * @param report The stream to print a line to as each job finishes, or nullptr.
+     * @return The outcome of every job, in the order of `jobs`.
+     */
+    std::vector<BatchResult> run(const std::vector<BatchJob> &jobs, std::ostream *report = nullptr);
+};
+
+#endif //DAW_BATCHRUNNER_HPP
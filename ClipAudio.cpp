@@ -0,0 +1,342 @@
+#include "ClipAudio.hpp"
+#include "Hash.hpp"
+#include "Kernels.hpp"
+#include "SampleBuffer.hpp"
+#include "StreamAudio.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/// The magic bytes at the start of every clip file
+static constexpr char clipMagic[8] = {'D', 'A', 'W', 'C', 'L', 'I', 'P', '\0'};
+
+/// The clip format version written and accepted
+static constexpr std::uint32_t clipVersion = 1;
+
+/// Frames rendered per block when writing a clip; large writes keep it disk bound
+static constexpr std::size_t writeBlockFrames = 16 * Audio::blockSize;
+
+static std::uint64_t clipPlaneStride(std::uint64_t frames, unsigned sampleBytes) {
+    std::uint64_t bytes = frames * sampleBytes;
+    return (bytes + ClipAudio::planeAlignment - 1) / ClipAudio::planeAlignment * ClipAudio::planeAlignment;
+}
+
+// Converts a plane block to the stored type, returning the bytes to store
+template<typename Stored>
+static const char *convertPlane(const sample *in, std::size_t count, std::vector<Stored> &scratch) {
+    if (std::is_same<Stored, sample>::value) {
+        return reinterpret_cast<const char *>(in);
+    }
+    scratch.assign(in, in + count);
+    return reinterpret_cast<const char *>(scratch.data());
+}
+
+std::uint64_t clipImageSize(const ClipHeader &header) {
+    if (header.channels == 0) {
+        return sizeof(ClipHeader);
+    }
+    // The last plane does not need its padding
+    return ClipAudio::planeAlignment + (header.channels - 1) * clipPlaneStride(header.frames, header.sampleBytes)
+           + header.frames * header.sampleBytes;
+}
+
+// A temporary file holding one plane while the length of a stream input is not yet known
+using SpoolFile = std::unique_ptr<std::FILE, int (*)(std::FILE *)>;
+
+ClipHeader writeClip(const Audio &audio, std::ostream &out, unsigned sampleBytes, std::uint64_t *contentHash,
+                     const StreamAudio *input) {
+    if (sampleBytes != 4 && sampleBytes != 8) {
+        throw std::invalid_argument("Clip samples must be 4 or 8 bytes, not " + std::to_string(sampleBytes));
+    }
+    std::streamoff base = out.tellp();
+    if (base < 0) {
+        throw std::runtime_error("Clip stream is not seekable");
+    }
+
+    ClipHeader header{};
+    std::memcpy(header.magic, clipMagic, sizeof(clipMagic));
+    header.version = clipVersion;
+    header.sampleBytes = sampleBytes;
+    header.channels = audio.getChannels();
+    header.sampleRate = audio.getSampleRate();
+    header.duration = audio.getDuration();
+    header.frames = audio.getSampleSize(); // Only an upper bound with a stream input
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header)); // Levels are patched in at the end
+
+    // With a stream input the plane stride depends on a length only known at the end, so the first
+    // plane is written in place and the others are spooled to temporary files and copied after it
+    std::vector<SpoolFile> spools;
+    if (input) {
+        for (unsigned c = 1; c < header.channels; ++c) {
+            spools.emplace_back(std::tmpfile(), &std::fclose);
+            if (!spools.back()) {
+                throw std::runtime_error("Failed to create a temporary file for clip planes");
+            }
+        }
+    }
+
+    std::uint64_t stride = clipPlaneStride(header.frames, sampleBytes);
+    const KernelSet &kernels = activeKernels();
+    PlanarBlock block(header.channels, writeBlockFrames);
+    std::vector<float> floats;
+    std::vector<double> doubles;
+    double peak = 0.0;
+    double sumSquares = 0.0;
+    std::uint64_t hash = 0;
+    std::uint64_t written = 0;
+
+    for (std::size_t pos = 0; pos < header.frames; pos += writeBlockFrames) {
+        std::size_t count = std::min<std::size_t>(writeBlockFrames, header.frames - pos);
+        AudioRegion region = audio.describeRegion(pos, count);
+        if (region.constant) {
+            for (unsigned c = 0; c < header.channels; ++c) {
+                std::fill(block[c], block[c] + count, region.value);
+            }
+        } else {
+            audio.render(pos, count, block.planes());
+        }
+        bool last = input && input->trimToEnd(pos, count);
+        for (unsigned c = 0; c < header.channels; ++c) {
+            if (sampleBytes < sizeof(sample)) {
+                // Level the values that are actually stored
+                for (std::size_t k = 0; k < count; ++k) {
+                    block[c][k] = static_cast<sample>(static_cast<float>(block[c][k]));
+                }
+            }
+            peak = std::max<double>(peak, kernels.peak(block[c], count));
+            sumSquares += kernels.sumSquares(block[c], count);
+
+            const char *bytes = (sampleBytes == 4) ? convertPlane(block[c], count, floats)
+                                                   : convertPlane(block[c], count, doubles);
+            if (c > 0 && input) {
+                if (std::fwrite(bytes, sampleBytes, count, spools[c - 1].get()) != count) {
+                    throw std::runtime_error("Failed to spool clip data");
+                }
+            } else {
+                out.seekp(base + static_cast<std::streamoff>(ClipAudio::planeAlignment + c * stride + pos * sampleBytes));
+                out.write(bytes, static_cast<std::streamsize>(count * sampleBytes));
+            }
+            if (contentHash) {
+                hash = hashBytes(bytes, count * sampleBytes, hash);
+            }
+        }
+        if (!out) {
+            throw std::runtime_error("Failed to write clip data");
+        }
+        written += count;
+        if (last) {
+            break;
+        }
+    }
+
+    if (input) {
+        header.frames = written;
+        header.duration = static_cast<double>(written) / header.sampleRate;
+        stride = clipPlaneStride(header.frames, sampleBytes);
+        std::vector<char> chunk(writeBlockFrames * sampleBytes);
+        for (unsigned c = 1; c < header.channels; ++c) {
+            std::FILE *spool = spools[c - 1].get();
+            std::rewind(spool);
+            out.seekp(base + static_cast<std::streamoff>(ClipAudio::planeAlignment + c * stride));
+            std::size_t n;
+            while ((n = std::fread(chunk.data(), 1, chunk.size(), spool)) > 0) {
+                out.write(chunk.data(), static_cast<std::streamsize>(n));
+            }
+            if (std::ferror(spool) || !out) {
+                throw std::runtime_error("Failed to copy spooled clip data");
+            }
+        }
+    }
+
+    std::uint64_t total = header.frames * header.channels;
+    header.peak = peak;
+    header.rms = total > 0 ? std::sqrt(sumSquares / static_cast<double>(total)) : 0.0;
+    out.seekp(base);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.seekp(base + static_cast<std::streamoff>(clipImageSize(header)));
+    if (!out) {
+        throw std::runtime_error("Failed to write clip header");
+    }
+    if (contentHash) {
+        *contentHash = hashBytes(&header, sizeof(header), hash);
+    }
+    return header;
+}
+
+ClipHeader writeClip(const Audio &audio, const char *fileName, unsigned sampleBytes, const StreamAudio *input) {
+    if (sampleBytes != 4 && sampleBytes != 8) {
+        throw std::invalid_argument("Clip samples must be 4 or 8 bytes, not " + std::to_string(sampleBytes));
+    }
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + std::string(fileName));
+    }
+    ClipHeader header;
+    try {
+        header = writeClip(audio, file, sampleBytes, nullptr, input);
+    } catch (const std::runtime_error &ex) {
+        throw std::runtime_error(std::string(ex.what()) + ": " + fileName);
+    }
+    file.close();
+    if (file.fail()) {
+        throw std::runtime_error("Failed to finish clip file: " + std::string(fileName));
+    }
+    return header;
+}
+
+ClipAudio::Mapping::Mapping(std::shared_ptr<const MappedFile> file, std::uint64_t base)
+        : file(std::move(file)), base(base) {
+    const std::string &path = this->file->getPath();
+    std::uint64_t size = this->file->size();
+    if (base % planeAlignment != 0 || base > size || size - base < sizeof(ClipHeader)) {
+        throw std::runtime_error("Invalid clip file: too short for a header: " + path);
+    }
+    std::memcpy(&header, this->file->data() + base, sizeof(header));
+    if (std::memcmp(header.magic, clipMagic, sizeof(clipMagic)) != 0) {
+        throw std::runtime_error("Invalid clip file: bad magic: " + path);
+    }
+    if (header.version != clipVersion) {
+        throw std::runtime_error("Unsupported clip version " + std::to_string(header.version) + ": " + path);
+    }
+    if ((header.sampleBytes != 4 && header.sampleBytes != 8) || header.channels == 0) {
+        throw std::runtime_error("Invalid clip file: bad sample size or channel count: " + path);
+    }
+    size -= base;
+    if (header.frames > size || header.channels > size || size < clipImageSize(header)) {
+        throw std::runtime_error("Invalid clip file: truncated sample data: " + path);
+    }
+    planeStride = clipPlaneStride(header.frames, header.sampleBytes);
+}
+
+const unsigned char *ClipAudio::Mapping::plane(unsigned channel) const {
+    return file->data() + base + planeAlignment + channel * planeStride;
+}
+
+ClipAudio::ClipAudio(const char *fileName) : ClipAudio([fileName]() {
+    try {
+        return std::make_shared<const MappedFile>(fileName);
+    } catch (const std::exception &ex) {
+        std::cerr << "Error loading clip: " << ex.what() << std::endl;
+        throw;
+    }
+}(), 0) {
+
+}
+
+ClipAudio::ClipAudio(std::shared_ptr<const MappedFile> file, std::uint64_t offset) : Audio() {
+    try {
+        mapping = std::make_shared<const Mapping>(std::move(file), offset);
+    } catch (const std::exception &ex) {
+        std::cerr << "Error loading clip: " << ex.what() << std::endl;
+        throw;
+    }
+    const ClipHeader &header = mapping->header;
+    this->setSampleRate(static_cast<float>(header.sampleRate));
+    this->setSampleSize(static_cast<std::size_t>(header.frames));
+    this->setDuration(header.duration);
+    this->setChannels(header.channels);
+}
+
+// Copies stored samples of either width into a plane
+static void copyStored(const unsigned char *plane, unsigned sampleBytes, std::size_t start, std::size_t count,
+                       sample *out) {
+    if (sampleBytes == sizeof(sample)) {
+        std::memcpy(out, plane + start * sampleBytes, count * sizeof(sample)); // Same layout as memory
+    } else if (sampleBytes == 4) {
+        const float *stored = reinterpret_cast<const float *>(plane) + start;
+        std::copy(stored, stored + count, out);
+    } else {
+        const double *stored = reinterpret_cast<const double *>(plane) + start;
+        std::transform(stored, stored + count, out, [](double value) { return static_cast<sample>(value); });
+    }
+}
+
+sample ClipAudio::operator[](std::size_t index) const {
+    if (index >= this->getSampleSize()) {
+        return 0;
+    }
+    sample value;
+    copyStored(mapping->plane(0), mapping->header.sampleBytes, index, 1, &value);
+    return value;
+}
+
+sample &ClipAudio::operator[](std::size_t /*index*/) {
+    throw std::logic_error("ClipAudio does not support sample modification.");
+}
+
+void ClipAudio::render(std::size_t start, std::size_t count, sample *const *out) const {
+    std::size_t size = this->getSampleSize();
+    std::size_t available = (start < size) ? std::min(count, size - start) : 0;
+    for (unsigned c = 0; c < this->getChannels(); ++c) {
+        copyStored(mapping->plane(c), mapping->header.sampleBytes, start, available, out[c]);
+        std::fill(out[c] + available, out[c] + count, 0.0);
+    }
+}
+
+AudioStats ClipAudio::analyze() const {
+    AudioStats stats;
+    stats.peak = mapping->header.peak;
+    stats.rms = mapping->header.rms;
+    return stats;
+}
+
+bool ClipAudio::getSource(AudioSource &source) const {
+    if (mapping->base != 0) {
+        return false; // Embedded in another file
+    }
+    source.path = canonicalPath(mapping->file->getPath());
+    if (source.path.empty()) {
+        return false; // Removed since it was mapped
+    }
+    source.command = "CLIP " + source.path;
+    return true;
+}
+
+ClipAudio *ClipAudio::clone() const {
+    return new ClipAudio(*this);
+}
+
+std::ostream &ClipAudio::printToStream(std::ostream &out) const {
+    out << "ClipAudio: " << mapping->file->getPath() << ", " << this->getSampleSize() << " samples x "
+        << this->getChannels() << " channels @ " << this->getSampleRate() << "Hz, "
+        << (mapping->header.sampleBytes == 4 ? "float" : "double") << "\n";
+    return out;
+}
+
+ClipAudioCreator::ClipAudioCreator() : AudioCreator("CLIP") {
+
+}
+
+bool ClipAudioCreator::readParameters(std::istream &in, std::string &parameters) const {
+    in >> parameters;
+    return true;
+}
+
+std::string ClipAudioCreator::getVersion(const std::string &parameters) const {
+    return fileVersion(parameters);
+}
+
+Audio *ClipAudioCreator::createAudio(std::istream &in) const {
+    try {
+
+        std::string fileName;
+        in >> fileName;
+
+        return new ClipAudio(fileName.c_str());
+
+    } catch (const std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        throw;
+    } catch (...) {
+        throw;
+    }
+}
+
+static ClipAudioCreator __;
@@ -0,0 +1,221 @@
+/**
+ * @file ClipAudio.hpp
+ * @brief Defines the native binary clip format, the ClipAudio reader and its creator.
+ */
+
+#ifndef DAW_CLIPAUDIO_HPP
+#define DAW_CLIPAUDIO_HPP
+
+#include "Audio.hpp"
+#include "MappedFile.hpp"
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief The fixed 64-byte header at the start of a clip file.
+ *
+ * It is followed by one plane per channel, each starting at a 64-byte aligned offset
+ * and holding `frames` raw little-endian floats or doubles. The layout matches
+ * the in-memory planes, so a mapped clip is used as it is, without parsing.
+ */
+struct ClipHeader {
+    char magic[8];              ///< "DAWCLIP" followed by a zero byte.
+    std::uint32_t version;      ///< Format version, currently 1.
+    std::uint32_t sampleBytes;  ///< 4 for float samples, 8 for double samples.
+    std::uint32_t channels;     ///< Number of planes.
+    std::uint32_t reserved;     ///< Zero.
+    double sampleRate;          ///< Sample rate in Hz.
+    double duration;            ///< Duration in seconds.
+    std::uint64_t frames;       ///< Samples per plane.
+    double peak;                ///< Cached peak level over all channels.
+    double rms;                 ///< Cached RMS level over all channels.
+};
+
+static_assert(sizeof(ClipHeader) == 64, "The clip header must stay 64 bytes");
+
+class StreamAudio;
+
+/**
+ * @brief Renders audio into a clip file, computing the cached levels on the way.
+ *
+ * The audio is rendered in order, one block at a time, so any graph can be written
+ * (including sequential sources) in bounded memory.
+ * @param audio The audio to write.
+ * @param fileName The path of the clip file to create/overwrite.
+ * @param sampleBytes 4 to store floats, 8 to store doubles; defaults to the build's sample type.
+ * @param input The sequential input feeding `audio`, if any; writing stops where it ends.
+ * @return The header written, with the actual number of frames.
+ * @throws std::invalid_argument if `sampleBytes` is neither 4 nor 8.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+ClipHeader writeClip(const Audio &audio, const char *fileName, unsigned sampleBytes = sizeof(sample),
+                     const StreamAudio *input = nullptr);
+
+/**
+ * @brief Renders audio as a clip image at the current position of a seekable stream.
+ *
+ * Used to embed clips in other files; the image starts with its header and its planes are
+ * aligned relative to the start position, so the start should be `ClipAudio::planeAlignment` aligned.
+ * @param audio The audio to write.
+ * @param out The destination stream, opened in binary mode and seekable.
+ * @param sampleBytes 4 to store floats, 8 to store doubles.
+ * @param contentHash If not null, receives a hash of the header and the stored samples.
+ * @param input The sequential input feeding `audio`, if any. Its length may be unknown until it
+ *        ends, so writing stops there and the frame count and duration are patched into the
+ *        header; planes after the first are spooled to temporary files until then.
+ * @return The header written, including the computed levels.
+ * @throws std::invalid_argument if `sampleBytes` is neither 4 nor 8.
+ * @throws std::runtime_error if the stream cannot be written.
+ */
+ClipHeader writeClip(const Audio &audio, std::ostream &out, unsigned sampleBytes = sizeof(sample),
+                     std::uint64_t *contentHash = nullptr, const StreamAudio *input = nullptr);
+
+/**
+ * @brief Gets the number of bytes a clip image occupies.
+ * @param header The header of the image.
+ * @return The size from the start of the header to the end of the last plane.
+ */
+std::uint64_t clipImageSize(const ClipHeader &header);
+
+/**
+ * @brief Audio read from a memory-mapped clip file.
+ *
+ * Loading only maps the file and checks the header, so it takes microseconds
+ * whatever the length. When the clip stores the build's sample type, rendering
+ * copies straight from the mapped planes; otherwise the samples are converted.
+ * The levels cached in the header are returned by `analyze()` without a scan.
+ * The audio is read-only; clones share the mapping.
+ */
+class ClipAudio : public Audio {
+private:
+    /**
+     * @brief State shared by every clone of one opened clip.
+     */
+    struct Mapping {
+        std::shared_ptr<const MappedFile> file; ///< The mapped file holding the clip.
+        std::uint64_t base = 0;                 ///< The byte offset of the clip image in the file.
+        ClipHeader header;                      ///< The validated header.
+        std::uint64_t planeStride = 0;          ///< Byte distance between the starts of two planes.
+
+        /**
+         * @brief Validates the header of a clip image in a mapped file.
+         * @param file The mapped file.
+         * @param base The byte offset of the clip image; must be `planeAlignment` aligned.
+         */
+        Mapping(std::shared_ptr<const MappedFile> file, std::uint64_t base);
+
+        /**
+         * @brief Gets the first byte of a plane.
+         * @param channel The channel.
+         * @return A pointer into the mapping.
+         */
+        const unsigned char *plane(unsigned channel) const;
+    };
+
+    std::shared_ptr<const Mapping> mapping; ///< The shared mapping.
+
+public:
+    /// @brief The byte offset of the first plane, and the alignment of every plane.
+    static constexpr std::uint64_t planeAlignment = 64;
+
+    /**
+     * @brief Maps a clip file.
+     * @param fileName The path of the clip file.
+     * @throws std::runtime_error if the file cannot be mapped or is not a valid clip.
+     */
+    explicit ClipAudio(const char *fileName);
+
+    /**
+     * @brief Opens a clip image embedded in an already mapped file, such as a project.
+     * @param file The mapped file, kept alive by the clip and its clones.
+     * @param offset The byte offset of the clip image; must be `planeAlignment` aligned.
+     * @throws std::runtime_error if the image is not a valid clip.
+     */
+    ClipAudio(std::shared_ptr<const MappedFile> file, std::uint64_t offset);
+
+    /**
+     * @brief Gets the command that reopens a stand-alone clip file.
+     * @param source Receives "CLIP <path>" and the path; left unchanged for embedded clips.
+     * @return True for a stand-alone clip file.
+     */
+    bool getSource(AudioSource &source) const override;
+
+    /**
+     * @brief Reads a sample of the first channel straight from the mapping.
+     * @param index The index of the sample.
+     * @return The sample value, or 0.0 past the end.
+     */
+    sample operator[](std::size_t index) const override;
+
+    /**
+     * @brief Accesses a sample (non-const version).
+     * @throws std::logic_error as clips are read-only.
+     * @param index The sample index (unused).
+     * @return A reference to a sample (never actually returns due to exception).
+     */
+    sample &operator[](std::size_t index) override;
+
+    /**
+     * @brief Copies a block of every channel from the mapped planes.
+     * @param start The index of the first sample to render.
+     * @param count The number of samples to render per channel.
+     * @param out One destination plane per channel; samples past the end are written as silence.
+     */
+    void render(std::size_t start, std::size_t count, sample *const *out) const override;
+
+    /**
+     * @brief Gets the levels cached in the clip header.
+     * @return The level statistics of the audio.
+     */
+    AudioStats analyze() const override;
+
+    /**
+     * @brief Clones the ClipAudio object.
+     * @return A pointer to a new ClipAudio sharing the same mapping.
+     */
+    ClipAudio *clone() const override;
+
+    /**
+     * @brief Prints a summary of the clip to an output stream.
+     * @param out The output stream.
+     * @return A reference to the output stream.
+     */
+    std::ostream &printToStream(std::ostream &out) const override;
+};
+
+/**
+ * @brief Creator class for ClipAudio objects.
+ *
+ * Responds to the "CLIP" command followed by a clip file name.
+ */
+class ClipAudioCreator : public AudioCreator {
+public:
+    /**
+     * @brief Constructs a ClipAudioCreator and registers it under "CLIP".
+     */
+    ClipAudioCreator();
+
+    /**
+     * @brief Reads the file name, so a live node for the file is found before it is mapped.
+     * @param in The input stream, positioned at the file name.
+     * @param parameters Receives the file name.
+     * @return True.
+     */
+    bool readParameters(std::istream &in, std::string &parameters) const override;
+
+    /**
+     * @brief Gets the version of the file, so a node made before the file changed is not reused.
+     * @param parameters The file name.
+     * @return The value of `fileVersion()` for the file.
+     */
+    std::string getVersion(const std::string &parameters) const override;
+
+    /**
+     * @brief Creates a ClipAudio object from an input stream.
+     * @param in The input stream, positioned at the file name.
+     * @return A pointer to the created ClipAudio object.
+     */
+    Audio *createAudio(std::istream &in) const override;
+};
+
+#endif //DAW_CLIPAUDIO_HPP
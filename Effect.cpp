@@ -1,6 +1,87 @@
 #include "Effect.hpp"
-#include "AudioFactory.hpp" // For AudioFactory::getInstance()
+#include "AudioFactory.hpp" // For AudioFactory::getInstance() and readCommand()
 #include <limits>           // For std::numeric_limits (for consuming line)
+#include <memory>           // For std::shared_ptr
+
+EffectOperationCreator::EffectOperationCreator(const char *command) : command(command), code(commandCode(command)) {
+    EffectFactory::getInstance().registerEffect(this);
+}
+
+std::uint32_t EffectOperationCreator::getCommandCode() const {
+    return this->code;
+}
+
+std::shared_ptr<const Audio> EffectOperationCreator::readBase(std::istream &in) const {
+    std::shared_ptr<const Audio> baseAudio = AudioFactory::getInstance().createShared(in);
+    if (!baseAudio) {
+        throw std::runtime_error(std::string("EffectCreator: Base audio creation failed for ") + this->command + " effect.");
+    }
+    return baseAudio;
+}
+
+void EffectOperationCreator::fail(std::istream &in, const char *what) const {
+    in.clear();
+    in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    throw std::runtime_error(std::string("EffectCreator: Missing or invalid ") + this->command + " " + what + ".");
+}
+
+EffectFactory &EffectFactory::getInstance() {
+    static EffectFactory effectFactory;
+    return effectFactory;
+}
+
+void EffectFactory::registerEffect(const EffectOperationCreator *creator) {
+    this->creators[creator->getCommandCode()] = creator;
+}
+
+const EffectOperationCreator *EffectFactory::getCreator(std::uint32_t code) const {
+    auto found = this->creators.find(code);
+    return (found != this->creators.end()) ? found->second : nullptr;
+}
+
+// Each creator reads its parameters, then the base audio, which the new Effect shares.
+
+AmplifyCreator::AmplifyCreator() : EffectOperationCreator("AMPL") {}
+
+Audio *AmplifyCreator::createEffect(std::istream &in) const {
+    double factor;
+    if (!(in >> factor)) {
+        this->fail(in, "factor");
+    }
+    return new Effect<Amplify>(this->readBase(in), Amplify(factor));
+}
+
+NormalizeCreator::NormalizeCreator() : EffectOperationCreator("NORM") {}
+
+Audio *NormalizeCreator::createEffect(std::istream &in) const {
+    double targetAmplitude;
+    if (!(in >> targetAmplitude)) {
+        this->fail(in, "target amplitude");
+    }
+    std::shared_ptr<const Audio> baseAudio = this->readBase(in);
+    Normalize op(*baseAudio, targetAmplitude); // Normalize op constructor needs const Audio&
+    return new Effect<Normalize>(std::move(baseAudio), op);
+}
+
+FadeInCreator::FadeInCreator() : EffectOperationCreator("FDIN") {}
+
+Audio *FadeInCreator::createEffect(std::istream &in) const {
+    double durationSeconds, configuredSampleRate;
+    if (!(in >> durationSeconds >> configuredSampleRate)) {
+        this->fail(in, "parameters (duration, sampleRate)");
+    }
+    return new Effect<FadeIn>(this->readBase(in), FadeIn(durationSeconds, configuredSampleRate));
+}
+
+FadeOutCreator::FadeOutCreator() : EffectOperationCreator("FOUT") {}
+
+Audio *FadeOutCreator::createEffect(std::istream &in) const {
+    double durationSeconds, configuredSampleRate;
+    if (!(in >> durationSeconds >> configuredSampleRate)) {
+        this->fail(in, "parameters (duration, sampleRate)");
+    }
+    return new Effect<FadeOut>(this->readBase(in), FadeOut(durationSeconds, configuredSampleRate));
+}
 
 EffectCreator::EffectCreator(const char* command) : AudioCreator(command) {
     // The base class AudioCreator(command) constructor handles registration
@@ -8,80 +89,27 @@ EffectCreator::EffectCreator(const char* command) : AudioCreator(command) {
 }
 
 Audio* EffectCreator::createAudio(std::istream& in) const {
-    std::string effectType;
-    if (!(in >> effectType)) {
-        if (in.eof()) { /* stream ended, nothing to do */ }
-        else if (in.fail() || in.bad()) { // If it's a formatting error or worse
+    std::uint32_t code = readCommand(in);
+    if (!in) {
+        if (!in.eof()) { // If it's a formatting error or worse
             in.clear(); // Clear error flags
             in.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Consume the problematic line
         }
         throw std::runtime_error("EffectCreator: Could not read effect type.");
     }
 
-    Audio* baseAudio = nullptr;
-//TODO try find a better looking code fix
-    try {
-        if (effectType == "AMPL") {
-            double factor;
-            if (!(in >> factor)) {
-                in.clear(); in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                throw std::runtime_error("EffectCreator: Missing or invalid amplify factor.");
-            }
-            baseAudio = AudioFactory::getInstance().createAudio(in);
-            if (!baseAudio) throw std::runtime_error("EffectCreator: Base audio creation failed for amplify effect.");
-            Amplify op(factor);
-            Effect<Amplify>* effect = new Effect<Amplify>(baseAudio, op);
-            baseAudio = nullptr; // Ownership transferred
-            return effect;
-        } else if (effectType == "NORM") {
-            double targetAmplitude;
-            if (!(in >> targetAmplitude)) {
-                in.clear(); in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                throw std::runtime_error("EffectCreator: Missing or invalid normalize target amplitude.");
-            }
-            baseAudio = AudioFactory::getInstance().createAudio(in);
-            if (!baseAudio) throw std::runtime_error("EffectCreator: Base audio creation failed for normalize effect.");
-            Normalize op(*baseAudio, targetAmplitude); // Normalize op constructor needs const Audio&
-            Effect<Normalize>* effect = new Effect<Normalize>(baseAudio, op);
-            baseAudio = nullptr; // Ownership transferred
-            return effect;
-        } else if (effectType == "FDIN") {
-            double durationSeconds, configuredSampleRate;
-            if (!(in >> durationSeconds >> configuredSampleRate)) {
-                in.clear(); in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                throw std::runtime_error("EffectCreator: Missing or invalid fadeIn parameters (duration, sampleRate).");
-            }
-            baseAudio = AudioFactory::getInstance().createAudio(in);
-            if (!baseAudio) throw std::runtime_error("EffectCreator: Base audio creation failed for fadeIn effect.");
-            FadeIn op(durationSeconds, configuredSampleRate);
-            Effect<FadeIn>* effect = new Effect<FadeIn>(baseAudio, op);
-            baseAudio = nullptr; // Ownership transferred
-            return effect;
-        } else if (effectType == "FOUT") {
-            double durationSeconds, configuredSampleRate;
-            if (!(in >> durationSeconds >> configuredSampleRate)) {
-                in.clear(); in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                throw std::runtime_error("EffectCreator: Missing or invalid fadeOut parameters (duration, sampleRate).");
-            }
-            baseAudio = AudioFactory::getInstance().createAudio(in);
-            if (!baseAudio) throw std::runtime_error("EffectCreator: Base audio creation failed for fadeOut effect.");
-            FadeOut op(durationSeconds, configuredSampleRate);
-            Effect<FadeOut>* effect = new Effect<FadeOut>(baseAudio, op);
-            baseAudio = nullptr; // Ownership transferred
-            return effect;
-        }
-            // Add more 'else if' blocks here for other effects like LowPass, HighPass, etc.
-            // when their operation structs and Effect specializations (if needed) are defined.
-        else {
-            // Consume the rest of the line for an unknown effect type to avoid parsing errors later.
-            in.clear();
-            in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-            throw std::runtime_error("EffectCreator: Unknown effect type: " + effectType);
-        }
-    } catch (...) {
-        delete baseAudio;
-        throw;
+    const EffectOperationCreator *creator = EffectFactory::getInstance().getCreator(code);
+    if (!creator) {
+        // Consume the rest of the line for an unknown effect type to avoid parsing errors later.
+        in.clear();
+        in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        throw std::runtime_error("EffectCreator: Unknown effect type: " + commandName(code));
     }
+    return creator->createEffect(in);
 }
 
+static AmplifyCreator amplifyCreator;
+static NormalizeCreator normalizeCreator;
+static FadeInCreator fadeInCreator;
+static FadeOutCreator fadeOutCreator;
 static EffectCreator __;
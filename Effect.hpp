@@ -7,51 +7,80 @@
 #define DAW_EFFECT_HPP
 
 #include "Audio.hpp"
+#include "Kernels.hpp"
+#include "SampleBuffer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 
 /**
  * @brief Functor to amplify an audio sample by a given factor.
  */
 struct Amplify {
 private:
-    double factor; ///< The amplification factor.
+    sample factor; ///< The amplification factor.
 public:
     /**
      * @brief Constructs an Amplify effect.
      * @param factor The amplification factor.
      */
-    Amplify(double factor) : factor(factor) {};
+    Amplify(double factor) : factor(static_cast<sample>(factor)) {};
 
     /**
      * @brief Applies the amplification.
      * @param s The input sample.
      * @return The amplified sample.
      */
-    double operator()(double s) const {
+    sample operator()(sample s) const {
         return s * factor;
     }
+
+    /**
+     * @brief Applies the amplification to a block with the vectorized kernels.
+     * @param out The block to process in place.
+     * @param start The index of the first sample in the block (unused).
+     * @param count The number of samples in the block.
+     * @param totalSamples The total number of samples in the audio (unused).
+     */
+    void process(sample *out, std::size_t /*start*/, std::size_t count, std::size_t /*totalSamples*/) const {
+        activeKernels().scale(out, count, factor);
+    }
+
+    /**
+     * @brief Writes the factory command of the operation, without its base.
+     * @param out The stream to write "AMPL factor" to.
+     */
+    void writeCommand(std::ostream &out) const {
+        out << "AMPL " << factor;
+    }
 };
 
 /**
  * @brief Functor to normalize an audio signal to a target amplitude.
  */
 struct Normalize {
-    double gain = 1.0; ///< The gain to apply to each sample.
+    sample gain = 1;   ///< The gain to apply to each sample.
     double target;     ///< The target peak amplitude.
 
     /**
      * @brief Constructs a Normalize effect.
      *
      * Calculates the gain needed to bring the peak amplitude of the audio
-     * to the target amplitude.
+     * to the target amplitude, using `Audio::analyze()` to find the peak.
      * @param a The input Audio object to analyze for normalization.
      * @param targetAmp The target peak amplitude (default is 1.0).
      */
     Normalize(const Audio &a, double targetAmp = 1.0) : target(targetAmp) {
-        double maxAmp = 0.0;
-        for (std::size_t i = 0; i < a.getSampleSize(); ++i) {
-            maxAmp = std::max(maxAmp, std::abs(a[i]));
-        }
-        gain = (maxAmp > 0.000001) ? (target / maxAmp) : 1.0; // Avoid division by zero or very small numbers
+        double maxAmp = a.analyze().peak; // Cached by in-memory sources, parallel scan otherwise
+        gain = static_cast<sample>((maxAmp > 0.000001) ? (target / maxAmp) : 1.0); // Avoid division by zero or very small numbers
     }
 
     /**
@@ -59,9 +88,31 @@ struct Normalize {
      * @param s The input sample.
      * @return The normalized sample.
      */
-    double operator()(double s) const {
+    sample operator()(sample s) const {
         return s * gain;
     }
+
+    /**
+     * @brief Applies the normalization gain to a block with the vectorized kernels.
+     * @param out The block to process in place.
+     * @param start The index of the first sample in the block (unused).
+     * @param count The number of samples in the block.
+     * @param totalSamples The total number of samples in the audio (unused).
+     */
+    void process(sample *out, std::size_t /*start*/, std::size_t count, std::size_t /*totalSamples*/) const {
+        activeKernels().scale(out, count, gain);
+    }
+
+    /**
+     * @brief Writes the factory command of the operation, without its base.
+     *
+     * The gain may have been found from other audio than the base it is applied to, so the
+     * command applies the resolved gain as an amplification.
+     * @param out The stream to write "AMPL gain" to.
+     */
+    void writeCommand(std::ostream &out) const {
+        out << "AMPL " << gain;
+    }
 };
 
 /**
@@ -88,13 +139,35 @@ struct FadeIn {
      *       If `i` is beyond `fadeSamples`, the multiplier is 1.0 (full volume).
      *       Otherwise, it's a linear ramp from 0.0 to 1.0.
      */
-    double operator()(std::size_t i, [[maybe_unused]] std::size_t totalSamples) const {
+    sample operator()(std::size_t i, [[maybe_unused]] std::size_t totalSamples) const {
         // TODO: Verify the logic of this operation, especially if totalSamples should be used.
         // Currently, totalSamples is unused. The fade is based on fadeDuration and sampleRate.
         std::size_t fadeSamples = static_cast<std::size_t>(fadeDuration * sampleRate);
         if (fadeSamples == 0) return 1.0; // Avoid division by zero if fadeDuration is too small
         if (i >= fadeSamples) return 1.0;
-        return static_cast<double>(i) / fadeSamples;
+        return static_cast<sample>(i) / static_cast<sample>(fadeSamples);
+    }
+
+    /**
+     * @brief Applies the fade-in to a block, using the vectorized gain ramp for the faded part.
+     * @param out The block to process in place.
+     * @param start The index of the first sample in the block.
+     * @param count The number of samples in the block.
+     * @param totalSamples The total number of samples in the audio (unused).
+     */
+    void process(sample *out, std::size_t start, std::size_t count, [[maybe_unused]] std::size_t totalSamples) const {
+        std::size_t fadeSamples = static_cast<std::size_t>(fadeDuration * sampleRate);
+        if (fadeSamples == 0 || start >= fadeSamples) return; // Whole block at full volume
+        std::size_t n = std::min(count, fadeSamples - start);
+        activeKernels().ramp(out, n, static_cast<sample>(start), sample(1), static_cast<sample>(fadeSamples));
+    }
+
+    /**
+     * @brief Writes the factory command of the operation, without its base.
+     * @param out The stream to write "FDIN seconds sampleRate" to.
+     */
+    void writeCommand(std::ostream &out) const {
+        out << "FDIN " << fadeDuration << ' ' << sampleRate;
     }
 };
 
@@ -119,88 +192,278 @@ struct FadeOut {
      * @param totalSamples The total number of samples in the audio.
      * @return The fade-out multiplier (0.0 to 1.0).
      */
-    double operator()(std::size_t i, std::size_t totalSamples) const {
+    sample operator()(std::size_t i, std::size_t totalSamples) const {
         std::size_t fadeSamples = static_cast<std::size_t>(fadeDuration * sampleRate);
         if (fadeSamples == 0) return 1.0; // No fade if duration is zero
         if (i >= totalSamples) return 0.0; // Should not happen if iterating up to totalSamples - 1
         // Start fading when (totalSamples - i) <= fadeSamples
         if (totalSamples - i <= fadeSamples) {
-            return static_cast<double>(totalSamples - i) / fadeSamples;
+            return static_cast<sample>(totalSamples - i) / static_cast<sample>(fadeSamples);
         }
         return 1.0; // Before fade-out period, full volume
     }
+
+    /**
+     * @brief Applies the fade-out to a block, using the vectorized gain ramp for the faded part.
+     * @param out The block to process in place.
+     * @param start The index of the first sample in the block.
+     * @param count The number of samples in the block.
+     * @param totalSamples The total number of samples in the audio.
+     */
+    void process(sample *out, std::size_t start, std::size_t count, std::size_t totalSamples) const {
+        std::size_t fadeSamples = static_cast<std::size_t>(fadeDuration * sampleRate);
+        if (fadeSamples == 0) return; // No fade if duration is zero
+        std::size_t end = start + count;
+        std::size_t fadeStart = (totalSamples > fadeSamples) ? totalSamples - fadeSamples : 0;
+        std::size_t from = std::max(start, fadeStart);
+        std::size_t to = std::min(end, totalSamples);
+        if (from < to) {
+            activeKernels().ramp(out + (from - start), to - from, static_cast<sample>(totalSamples - from), sample(-1),
+                                 static_cast<sample>(fadeSamples));
+        }
+        if (to < end) {
+            std::fill(out + (std::max(to, start) - start), out + count, 0.0); // Past the end of the audio
+        }
+    }
+
+    /**
+     * @brief Writes the factory command of the operation, without its base.
+     * @param out The stream to write "FOUT seconds sampleRate" to.
+     */
+    void writeCommand(std::ostream &out) const {
+        out << "FOUT " << fadeDuration << ' ' << sampleRate;
+    }
 };
 
 /**
- * @brief A template class that applies an effect operation to an Audio object.
+ * @brief Detects operations that provide a vectorized `process(out, start, count, totalSamples)` block method.
+ * @tparam EffectOperation The effect operation functor type.
+ */
+template<typename EffectOperation, typename = void>
+struct HasBlockProcess : std::false_type {};
+
+template<typename EffectOperation>
+struct HasBlockProcess<EffectOperation, std::void_t<decltype(std::declval<const EffectOperation &>().process(
+        std::declval<sample *>(), std::size_t{}, std::size_t{}, std::size_t{}))>> : std::true_type {};
+
+/**
+ * @brief Detects operations that can write their factory command with `writeCommand(out)`.
+ * @tparam EffectOperation The effect operation functor type.
+ */
+template<typename EffectOperation, typename = void>
+struct HasCommand : std::false_type {};
+
+template<typename EffectOperation>
+struct HasCommand<EffectOperation, std::void_t<decltype(std::declval<const EffectOperation &>().writeCommand(
+        std::declval<std::ostream &>()))>> : std::true_type {};
+
+/**
+ * @brief Compile-time description of how an effect operation is applied to a sample.
  *
- * This class takes an `EffectOperation` (a functor like Amplify, Normalize, FadeIn, FadeOut)
- * and applies it to the samples of the base audio.
+ * Sample-wise operations (Amplify, Normalize) are called as `op(sample)`.
+ * Index-based operations (FadeIn, FadeOut) are called as `op(index, totalSamples)` and
+ * return a gain multiplier. The kind is detected from the operation's call signature;
+ * a new operation only needs its own specialization if it fits neither shape.
+ * Operations with a `process()` block method are applied through it on whole blocks.
  *
- * @tparam EffectOperation The type of effect to apply. It must be a callable
- *         object that takes a double (sample) and returns a double (modified sample),
- *         or for specific effects like FadeIn/FadeOut, it might take (sample_index, total_samples)
- *         and return a multiplier.
+ * @tparam EffectOperation The effect operation functor type.
  */
 template<typename EffectOperation>
+struct EffectTraits {
+    /// @brief True if the operation computes a gain from the sample index rather than the sample value.
+    static constexpr bool isIndexed = std::is_invocable_v<const EffectOperation &, std::size_t, std::size_t>;
+
+    /**
+     * @brief Applies the operation to one sample.
+     * @param op The operation instance.
+     * @param s The input sample.
+     * @param i The index of the sample.
+     * @param totalSamples The total number of samples in the base audio.
+     * @return The processed sample.
+     */
+    static sample apply(const EffectOperation &op, sample s, std::size_t i, std::size_t totalSamples) {
+        if constexpr (isIndexed) {
+            return s * op(i, totalSamples);
+        } else {
+            return op(s);
+        }
+    }
+
+    /**
+     * @brief Applies the operation to a block in place.
+     *
+     * Uses the operation's vectorized `process()` when it has one, otherwise falls back to `apply()`.
+     * @param op The operation instance.
+     * @param out The block to process in place.
+     * @param start The index of the first sample in the block.
+     * @param count The number of samples in the block.
+     * @param totalSamples The total number of samples in the base audio.
+     */
+    static void applyBlock(const EffectOperation &op, sample *out, std::size_t start, std::size_t count,
+                           std::size_t totalSamples) {
+        if constexpr (HasBlockProcess<EffectOperation>::value) {
+            op.process(out, start, count, totalSamples);
+        } else {
+            for (std::size_t k = 0; k < count; ++k) {
+                out[k] = apply(op, out[k], start + k, totalSamples);
+            }
+        }
+    }
+
+    /**
+     * @brief Describes the output of the operation over a region whose input is known.
+     *
+     * A sample-wise operation maps a constant region to another constant; an index-based
+     * gain keeps silence silent but turns any other constant into a varying signal.
+     * @param op The operation instance.
+     * @param region The region of the input.
+     * @return The region of the output.
+     */
+    static AudioRegion applyRegion(const EffectOperation &op, AudioRegion region) {
+        if (region.constant) {
+            if constexpr (isIndexed) {
+                region.constant = (region.value == 0);
+            } else {
+                region.value = op(region.value);
+            }
+        }
+        return region;
+    }
+};
+
+/**
+ * @brief A template class that applies one or more effect operations to an Audio object.
+ *
+ * This class takes a list of `Operations` (functors like Amplify, Normalize, FadeIn, FadeOut)
+ * and applies them, in order, to the samples of the base audio. Chaining operations through
+ * `then()` produces a single fused type, so a whole chain is evaluated with one virtual call
+ * per block and one loop over the base samples with every operation inlined.
+ *
+ * @tparam Operations The types of effect to apply, first to last. Each must be a callable
+ *         object that takes a sample and returns a modified sample,
+ *         or for specific effects like FadeIn/FadeOut, it might take (sample_index, total_samples)
+ *         and return a multiplier. See `EffectTraits`.
+ */
+template<typename... Operations>
 class Effect : public Audio {
+    static_assert(sizeof...(Operations) > 0, "Effect requires at least one operation.");
+
 private:
     /**
-     * @brief Pointer to the base Audio object.
-     * @note Using a pointer to the base Audio object allows for polymorphism
-     *       but requires careful memory management (cloning and deletion).
-     *       A reference might be considered if ownership semantics were different,
-     *       but cloning is essential here to ensure the Effect owns its base audio data.
+     * @brief The base Audio object.
+     * @note The base is immutable and shared: copies of an Effect, and chains built with
+     *       `then()`, reference the same base instead of cloning it, so each stage costs O(1) memory.
      */
-    const Audio *base;
-    EffectOperation operation; ///< The effect operation functor.
+    std::shared_ptr<const Audio> base;
+    std::tuple<Operations...> operations; ///< The effect operation functors, in application order.
 
-public:
     /**
-     * @brief Constructs an Effect object.
-     * @param input A pointer to the base Audio object. The Effect class will take ownership by cloning this object.
-     * @param op The effect operation to apply.
+     * @brief Applies every operation, in order, to a single sample.
+     * @param s The input sample.
+     * @param i The index of the sample.
+     * @param totalSamples The total number of samples in the base audio.
+     * @return The processed sample.
      */
-    Effect(const Audio *input, EffectOperation op);
+    template<std::size_t... I>
+    sample applyAll(sample s, std::size_t i, std::size_t totalSamples, std::index_sequence<I...>) const;
 
     /**
-     * @brief Copy constructor.
-     * @param other The Effect object to copy.
+     * @brief Applies every operation, in order, to a cache-resident block.
+     * @param out The block to process in place.
+     * @param start The index of the first sample in the block.
+     * @param count The number of samples in the block.
+     * @param totalSamples The total number of samples in the base audio.
      */
-    Effect(const Effect &other);
+    template<std::size_t... I>
+    void applyAllBlock(sample *out, std::size_t start, std::size_t count, std::size_t totalSamples,
+                       std::index_sequence<I...>) const;
 
+    template<typename... Other>
+    friend class Effect;
+
+public:
     /**
-     * @brief Assignment operator.
-     * @param other The Effect object to assign from.
-     * @return A reference to this Effect object.
-     * @note This operator performs a deep copy of the base audio data.
-     *       Consider exception safety: if `other.base->clone()` throws, `base` is not deleted,
-     *       which is acceptable as the object state remains valid.
+     * @brief Constructs an Effect object over a copy of the given audio.
+     * @param input A pointer to the base Audio object. The Effect class keeps its own clone of this object;
+     *              for in-memory sources the clone shares the sample buffer, so this does not copy samples.
+     * @param ops The effect operations to apply, first to last.
      */
-    Effect &operator=(const Effect &other);
+    Effect(const Audio *input, Operations... ops);
 
     /**
-     * @brief Destructor. Deletes the cloned base Audio object.
+     * @brief Constructs an Effect object that takes or shares ownership of the base audio.
+     *
+     * Pass a `std::unique_ptr<Audio>` by move to hand over ownership, or a
+     * `std::shared_ptr<const Audio>` to share an immutable base between several effects.
+     * @param input The base Audio object. Must not be null.
+     * @param ops The effect operations to apply, first to last.
      */
-    ~Effect() {
-        delete base;
-    }
+    Effect(std::shared_ptr<const Audio> input, Operations... ops);
+
+    /**
+     * @brief Appends an operation to this chain at compile time.
+     *
+     * The result wraps the same base audio and applies `next` after all current
+     * operations, fused into a single loop.
+     * @tparam Next The type of the operation to append.
+     * @param next The operation to append.
+     * @return The fused Effect.
+     */
+    template<typename Next>
+    Effect<Operations..., Next> then(Next next) const;
 
     /**
      * @brief Clones the Effect object.
-     * @return A pointer to a new Effect object, which is a deep copy of this one.
+     * @return A pointer to a new Effect object sharing the same immutable base audio.
      */
     Audio *clone() const override;
 
     /**
-     * @brief Accesses a sample with the effect applied (const version).
-     *
-     * For most effects, this applies `operation(base_sample)`.
-     * For effects like FadeIn/FadeOut, specializations are provided.
+     * @brief Accesses a sample of the first channel with the effects applied (const version).
      * @param i The sample index.
-     * @return The value of the sample at index `i` after the effect is applied.
+     * @return The value of the sample at index `i` after every operation is applied.
      */
-    double operator[](std::size_t i) const override;
+    sample operator[](std::size_t i) const override;
+
+    /**
+     * @brief Renders a block of every channel with the effects applied.
+     *
+     * The base audio renders the block once, then each operation is applied in place,
+     * one `blockSize` chunk at a time and every channel of that chunk in turn, while
+     * the chunk is still cache resident. Chunks that `describeRegion()` reports as
+     * constant are filled without rendering the base or running the operations.
+     * @param start The index of the first sample to render.
+     * @param count The number of samples to render per channel.
+     * @param out One destination plane per channel.
+     */
+    void render(std::size_t start, std::size_t count, sample *const *out) const override;
+
+    /**
+     * @brief Describes a range of the output from the base audio's description of it.
+     *
+     * Constant input regions are passed through every operation, so silence stays
+     * silence through gains and fades without rendering a sample.
+     * @param start The index of the first sample of the range.
+     * @param count The number of samples in the range.
+     * @return The region of the processed output.
+     */
+    AudioRegion describeRegion(std::size_t start, std::size_t count) const override;
+
+    /**
+     * @brief Checks whether the base audio can be rendered in any order.
+     * @return The base audio's answer, as effects render sample-aligned with their base.
+     */
+    bool isRandomAccess() const override;
+
+    /**
+     * @brief Describes how to recreate the effect from the base audio's source.
+     *
+     * Each operation wraps the command of the one before it, so a fused chain is written
+     * as nested "EFCT" commands with the last operation outermost.
+     * @param source Set to the effect's command and the file the base reads, if any.
+     * @return True if the base has a source and every operation has a command.
+     */
+    bool getSource(AudioSource &source) const override;
 
     /**
      * @brief Accesses a sample (non-const version).
@@ -208,7 +471,7 @@ public:
      * @param i The sample index.
      * @return A reference to the sample at index `i`.
      */
-    double &operator[](std::size_t i) override;
+    sample &operator[](std::size_t i) override;
 
     /**
      * @brief Prints the effect's audio data to an output stream.
@@ -221,15 +484,22 @@ public:
 
 /**
  * @brief Implementation of printToStream for the Effect class.
- * @tparam EffectOperation The type of the effect operation.
+ * @tparam Operations The types of the effect operations.
  * @param out The output stream.
  * @return A reference to the output stream.
  */
-template<typename EffectOperation>
-std::ostream &Effect<EffectOperation>::printToStream(std::ostream &out) const {
+template<typename... Operations>
+std::ostream &Effect<Operations...>::printToStream(std::ostream &out) const {
     out << this->getDuration() << '\t' << this->getSampleRate() << '\t' << this->getSampleSize() << '\t';
-    for (size_t i = 0; i < this->getSampleSize(); ++i) {
-        out << (*this)[i] << ' '; // Use the effect's own operator[] const
+    PlanarBlock block(this->getChannels());
+    for (size_t pos = 0; pos < this->getSampleSize(); pos += Audio::blockSize) {
+        size_t count = std::min(Audio::blockSize, this->getSampleSize() - pos);
+        this->render(pos, count, block.planes()); // Use the effect's own block render
+        for (size_t k = 0; k < count; ++k) {
+            for (unsigned c = 0; c < block.channels(); ++c) { // Frames are printed interleaved
+                out << block[c][k] << ' ';
+            }
+        }
     }
     out << std::endl;
     return out;
@@ -237,125 +507,383 @@ std::ostream &Effect<EffectOperation>::printToStream(std::ostream &out) const {
 
 /**
  * @brief Implementation of the non-const array access operator.
- * @tparam EffectOperation The type of the effect operation.
+ * @tparam Operations The types of the effect operations.
  * @param i The sample index (unused).
  * @throws std::logic_error Always, as effects are designed to be immutable post-creation.
  * @return A reference to a double (never actually returns due to exception).
  */
-template<typename EffectOperation>
-double &Effect<EffectOperation>::operator[](std::size_t /*i*/) { // Marked i as unused
+template<typename... Operations>
+sample &Effect<Operations...>::operator[](std::size_t /*i*/) { // Marked i as unused
     throw std::logic_error("Effect does not support sample modification.");
 }
 
 /**
- * @brief Default implementation of the const array access operator.
- *
- * This version is used for effects that operate on a single sample value
- * (e.g., Amplify, Normalize).
- * @tparam EffectOperation The type of the effect operation.
+ * @brief Implementation of the per-sample fold over all operations.
+ * @tparam Operations The types of the effect operations.
+ * @param s The input sample.
+ * @param i The index of the sample.
+ * @param totalSamples The total number of samples in the base audio.
+ * @return The processed sample.
+ */
+template<typename... Operations>
+template<std::size_t... I>
+inline sample Effect<Operations...>::applyAll(sample s, std::size_t i, std::size_t totalSamples,
+                                              std::index_sequence<I...>) const {
+    ((s = EffectTraits<Operations>::apply(std::get<I>(operations), s, i, totalSamples)), ...);
+    return s;
+}
+
+/**
+ * @brief Implementation of the block-wise pass over all operations.
+ * @tparam Operations The types of the effect operations.
+ * @param out The block to process in place.
+ * @param start The index of the first sample in the block.
+ * @param count The number of samples in the block.
+ * @param totalSamples The total number of samples in the base audio.
+ */
+template<typename... Operations>
+template<std::size_t... I>
+inline void Effect<Operations...>::applyAllBlock(sample *out, std::size_t start, std::size_t count,
+                                                 std::size_t totalSamples, std::index_sequence<I...>) const {
+    (EffectTraits<Operations>::applyBlock(std::get<I>(operations), out, start, count, totalSamples), ...);
+}
+
+/**
+ * @brief Implementation of the const array access operator.
+ * @tparam Operations The types of the effect operations.
  * @param i The sample index.
  * @return The processed sample value.
  */
-template<typename EffectOperation>
-double Effect<EffectOperation>::operator[](std::size_t i) const {
-    return operation((*base)[i]);
+template<typename... Operations>
+sample Effect<Operations...>::operator[](std::size_t i) const {
+    return applyAll((*base)[i], i, base->getSampleSize(), std::index_sequence_for<Operations...>{});
+}
+
+/**
+ * @brief Implementation of the fused block render.
+ * @tparam Operations The types of the effect operations.
+ * @param start The index of the first sample to render.
+ * @param count The number of samples to render.
+ * @param out One destination plane per channel.
+ */
+template<typename... Operations>
+void Effect<Operations...>::render(std::size_t start, std::size_t count, sample *const *out) const {
+    std::size_t total = base->getSampleSize();
+    if (count <= Audio::blockSize) { // The common case: one block, rendered in place
+        AudioRegion region = this->describeRegion(start, count);
+        if (region.constant) {
+            for (unsigned c = 0; c < this->getChannels(); ++c) {
+                std::fill(out[c], out[c] + count, region.value);
+            }
+            return;
+        }
+        base->render(start, count, out);
+        for (unsigned c = 0; c < this->getChannels(); ++c) {
+            applyAllBlock(out[c], start, count, total, std::index_sequence_for<Operations...>{});
+        }
+        return;
+    }
+    std::vector<sample *> block(this->getChannels());
+    for (std::size_t pos = 0; pos < count; pos += Audio::blockSize) {
+        std::size_t n = std::min(Audio::blockSize, count - pos);
+        for (unsigned c = 0; c < this->getChannels(); ++c) {
+            block[c] = out[c] + pos;
+        }
+        this->render(start + pos, n, block.data());
+    }
+}
+
+/**
+ * @brief Implementation of describeRegion, folding the base region through every operation.
+ * @tparam Operations The types of the effect operations.
+ * @param start The index of the first sample of the range.
+ * @param count The number of samples in the range.
+ * @return The region of the processed output.
+ */
+template<typename... Operations>
+AudioRegion Effect<Operations...>::describeRegion(std::size_t start, std::size_t count) const {
+    AudioRegion region = base->describeRegion(start, count);
+    std::apply([&](const Operations &... ops) {
+        ((region = EffectTraits<Operations>::applyRegion(ops, region)), ...);
+    }, operations);
+    return region;
+}
+
+/**
+ * @brief Implementation of compile-time chaining.
+ * @tparam Operations The types of the current effect operations.
+ * @tparam Next The type of the operation to append.
+ * @param next The operation to append.
+ * @return A fused Effect sharing the same base audio.
+ */
+template<typename... Operations>
+template<typename Next>
+Effect<Operations..., Next> Effect<Operations...>::then(Next next) const {
+    return std::apply([&](const Operations &... ops) {
+        return Effect<Operations..., Next>(base, ops..., next);
+    }, operations);
 }
 
 /**
  * @brief Implementation of the clone method.
- * @tparam EffectOperation The type of the effect operation.
+ * @tparam Operations The types of the effect operations.
  * @return A pointer to a new, dynamically allocated copy of this Effect.
  */
-template<typename EffectOperation>
-Audio *Effect<EffectOperation>::clone() const {
-    return new Effect<EffectOperation>(*this);
+template<typename... Operations>
+Audio *Effect<Operations...>::clone() const {
+    return new Effect<Operations...>(*this);
 }
 
 /**
- * @brief Implementation of the assignment operator.
- * @tparam EffectOperation The type of the effect operation.
- * @param other The Effect object to assign from.
- * @return A reference to this Effect object.
- * @note Regarding exception safety for `other.base->clone()`: If it throws, `this->base`
- *       is not yet deleted, and the object remains in its original valid state.
- *       The old `base` is only deleted after the new `base` (temp) is successfully cloned.
+ * @brief Implementation of isRandomAccess, forwarded to the base audio.
+ * @tparam Operations The types of the effect operations.
+ * @return True if the base audio accepts renders in any order.
  */
-template<typename EffectOperation>
-Effect<EffectOperation> &Effect<EffectOperation>::operator=(const Effect &other) {
-    if (this != &other) {
-        Audio *temp = other.base->clone(); // Potential throw here
-        delete base; // Safe to delete old base now
-        base = temp;
-        operation = other.operation;
-        // Update properties from the new base audio
-        setSampleRate(base->getSampleRate());
-        setDuration(base->getDuration());
-        setSampleSize(base->getSampleSize());
-    }
-    return *this;
+template<typename... Operations>
+bool Effect<Operations...>::isRandomAccess() const {
+    return base->isRandomAccess();
 }
 
 /**
- * @brief Implementation of the copy constructor.
- * @tparam EffectOperation The type of the effect operation.
- * @param other The Effect object to copy from.
+ * @brief Implementation of getSource, nesting one "EFCT" command per operation around the base's command.
+ * @tparam Operations The types of the effect operations.
+ * @param source Set to the effect's source.
+ * @return True if the effect can be recreated from a command.
  */
-template<typename EffectOperation>
-Effect<EffectOperation>::Effect(const Effect &other) : base(other.base->clone()), operation(other.operation) {
-    setSampleRate(base->getSampleRate());
-    setDuration(base->getDuration());
-    setSampleSize(base->getSampleSize());
+template<typename... Operations>
+bool Effect<Operations...>::getSource(AudioSource &source) const {
+    if constexpr (!(HasCommand<Operations>::value && ...)) {
+        return false;
+    } else {
+        AudioSource baseSource;
+        if (!base->getSource(baseSource)) {
+            return false;
+        }
+        std::string command = std::move(baseSource.command);
+        std::apply([&](const Operations &... ops) {
+            ((command = [&] {
+                std::ostringstream wrapped;
+                wrapped.precision(std::numeric_limits<double>::max_digits10); // Parameters read back exactly
+                wrapped << "EFCT ";
+                ops.writeCommand(wrapped);
+                wrapped << ' ' << command;
+                return wrapped.str();
+            }()), ...);
+        }, operations);
+        source.command = std::move(command);
+        source.path = std::move(baseSource.path);
+        return true;
+    }
 }
 
 /**
- * @brief Implementation of the constructor taking a base Audio and an operation.
- * @tparam EffectOperation The type of the effect operation.
+ * @brief Implementation of the constructor taking a base Audio pointer and the operations.
+ * @tparam Operations The types of the effect operations.
  * @param input Pointer to the base Audio object. This object will be cloned.
- * @param op The effect operation functor.
+ * @param ops The effect operation functors, first to last.
  */
-template<typename EffectOperation>
-Effect<EffectOperation>::Effect(const Audio *input, EffectOperation op) :base(input->clone()),
-                                                                         operation(op) {
+template<typename... Operations>
+Effect<Operations...>::Effect(const Audio *input, Operations... ops)
+        : Effect(std::shared_ptr<const Audio>(input->clone()), std::move(ops)...) {
+}
+
+/**
+ * @brief Implementation of the constructor taking ownership of the base Audio and the operations.
+ * @tparam Operations The types of the effect operations.
+ * @param input The base Audio object, owned or shared.
+ * @param ops The effect operation functors, first to last.
+ */
+template<typename... Operations>
+Effect<Operations...>::Effect(std::shared_ptr<const Audio> input, Operations... ops) : base(std::move(input)),
+                                                                                       operations(std::move(ops)...) {
+    if (!base) {
+        throw std::invalid_argument("Effect requires a base audio.");
+    }
     this->setDuration(base->getDuration());
     this->setSampleRate(base->getSampleRate());
     this->setSampleSize(base->getSampleSize());
+    this->setChannels(base->getChannels());
 }
 
 /**
- * @brief Specialization of the const array access operator for FadeIn effects.
+ * @brief Base class for creators of one kind of effect operation.
  *
- * This operator applies the fade-in logic, which depends on the current sample index
- * and the total number of samples.
- * @param i The current sample index.
- * @return The sample value after applying the fade-in effect.
- * @note This specialization is provided because FadeIn::operator() has a different signature
- *       (takes index and total samples) compared to simpler effects like Amplify.
+ * Each creator handles one four-character operation code after "EFCT" (e.g. "AMPL") and
+ * registers itself with the `EffectFactory` when constructed, so a new effect only needs a
+ * creator and a static instance of it.
  */
-template<>
-inline double Effect<FadeIn>::operator[](std::size_t i) const {
-    return (*base)[i] * operation(i, base->getSampleSize());
-}
+class EffectOperationCreator {
+protected:
+    /// @brief The operation command, e.g. "AMPL".
+    const char *command;
+    /// @brief The command packed by `commandCode()`.
+    std::uint32_t code;
+
+    /**
+     * @brief Reads the base audio that follows the operation parameters.
+     *
+     * The base goes through `AudioFactory::createShared()`, so effects over the same base share it.
+     * @param in The input stream.
+     * @return The base audio.
+     * @throws std::runtime_error if the base audio cannot be created.
+     */
+    std::shared_ptr<const Audio> readBase(std::istream &in) const;
+
+    /**
+     * @brief Discards the rest of the line and reports invalid parameters.
+     * @param in The input stream.
+     * @param what A description of the parameters that could not be read.
+     * @throws std::runtime_error always.
+     */
+    [[noreturn]] void fail(std::istream &in, const char *what) const;
+
+public:
+    /**
+     * @brief Constructs the creator and registers it with the EffectFactory.
+     * @param command The operation command of one to four characters.
+     */
+    explicit EffectOperationCreator(const char *command);
+
+    /**
+     * @brief Virtual destructor.
+     */
+    virtual ~EffectOperationCreator() = default;
+
+    /**
+     * @brief Gets the packed operation code of this creator.
+     * @return The value of `commandCode()` for the command.
+     */
+    std::uint32_t getCommandCode() const;
+
+    /**
+     * @brief Creates the effect from the operation parameters and base audio on the stream.
+     * @param in The input stream, positioned after the operation command.
+     * @return The created effect.
+     */
+    virtual Audio *createEffect(std::istream &in) const = 0;
+};
 
 /**
- * @brief Specialization of the const array access operator for FadeOut effects.
- *
- * This operator applies the fade-out logic, which depends on the current sample index
- * and the total number of samples.
- * @param i The current sample index.
- * @return The sample value after applying the fade-out effect.
- * @note This specialization is provided because FadeOut::operator() has a different signature
- *       (takes index and total samples) compared to simpler effects like Amplify.
+ * @brief A singleton registry of effect operation creators, keyed by packed operation code.
  */
-template<>
-inline double Effect<FadeOut>::operator[](std::size_t i) const {
-    // Similar to FadeIn, provides current index and total samples to the operation.
-    return (*base)[i] * operation(i, base->getSampleSize());
-}
+class EffectFactory {
+private:
+    /// @brief The registered creators.
+    std::unordered_map<std::uint32_t, const EffectOperationCreator *> creators;
+
+    /**
+     * @brief Private constructor to enforce singleton pattern.
+     */
+    EffectFactory() = default;
+
+    /**
+     * @brief Deleted copy constructor to prevent copying.
+     */
+    EffectFactory(const EffectFactory &other) = delete;
+
+    /**
+     * @brief Deleted assignment operator to prevent assignment.
+     */
+    EffectFactory &operator=(const EffectFactory &other) = delete;
+
+public:
+    /**
+     * @brief Gets the singleton instance of the EffectFactory.
+     * @return A reference to the EffectFactory instance.
+     */
+    static EffectFactory &getInstance();
+
+    /**
+     * @brief Registers a creator. A later creator for the same operation replaces the earlier one.
+     * @param creator The creator to register.
+     */
+    void registerEffect(const EffectOperationCreator *creator);
+
+    /**
+     * @brief Gets the creator of an operation.
+     * @param code The packed operation code.
+     * @return The creator, or nullptr if none is registered.
+     */
+    const EffectOperationCreator *getCreator(std::uint32_t code) const;
+};
+
+/**
+ * @brief Creates `Amplify` effects: "AMPL factor <base>".
+ */
+class AmplifyCreator : public EffectOperationCreator {
+public:
+    /**
+     * @brief Constructs the creator for "AMPL".
+     */
+    AmplifyCreator();
+
+    /**
+     * @brief Creates an amplified audio from the stream.
+     * @param in The input stream.
+     * @return The created effect.
+     */
+    Audio *createEffect(std::istream &in) const override;
+};
+
+/**
+ * @brief Creates `Normalize` effects: "NORM target <base>".
+ */
+class NormalizeCreator : public EffectOperationCreator {
+public:
+    /**
+     * @brief Constructs the creator for "NORM".
+     */
+    NormalizeCreator();
+
+    /**
+     * @brief Creates a normalized audio from the stream.
+     * @param in The input stream.
+     * @return The created effect.
+     */
+    Audio *createEffect(std::istream &in) const override;
+};
+
+/**
+ * @brief Creates `FadeIn` effects: "FDIN seconds sampleRate <base>".
+ */
+class FadeInCreator : public EffectOperationCreator {
+public:
+    /**
+     * @brief Constructs the creator for "FDIN".
+     */
+    FadeInCreator();
+
+    /**
+     * @brief Creates a faded-in audio from the stream.
+     * @param in The input stream.
+     * @return The created effect.
+     */
+    Audio *createEffect(std::istream &in) const override;
+};
+
+/**
+ * @brief Creates `FadeOut` effects: "FOUT seconds sampleRate <base>".
+ */
+class FadeOutCreator : public EffectOperationCreator {
+public:
+    /**
+     * @brief Constructs the creator for "FOUT".
+     */
+    FadeOutCreator();
+
+    /**
+     * @brief Creates a faded-out audio from the stream.
+     * @param in The input stream.
+     * @return The created effect.
+     */
+    Audio *createEffect(std::istream &in) const override;
+};
 
 /**
  * @brief Creator class for Effect objects.
  *
- * Inherits from AudioCreator to allow Effect creation through the AudioFactory.
+ * Inherits from AudioCreator to allow Effect creation through the AudioFactory. The operation
+ * command that follows "EFCT" is dispatched to the creator registered for it in the EffectFactory.
  */
 class EffectCreator : public AudioCreator {
 public:
@@ -372,8 +900,7 @@ public:
      * information from the stream to construct an appropriate Effect object.
      * @param in The input stream.
      * @return A pointer to the created Audio (Effect) object.
-     * @note The actual implementation of how effects are specified and created from
-     *       the stream is defined in the corresponding .cpp file.
+     * @throws std::runtime_error if no creator is registered for the operation.
      */
     Audio* createAudio(std::istream& in) const override;
 };
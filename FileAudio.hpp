@@ -6,27 +6,24 @@
 #ifndef DAW_FILEAUDIO_HPP
 #define DAW_FILEAUDIO_HPP
 #include "Audio.hpp"
+#include "SampleBuffer.hpp"
+#include "WavWriter.hpp"
 #include <fstream>
+#include <string>
 
 /**
  * @brief Represents an audio object whose data is primarily sourced from or destined for a file.
  *
  * This class extends the base `Audio` class to include a buffer for audio samples
  * and methods for reading from and writing to various file formats (TXT, WAV).
+ * Samples are stored planar, one aligned plane per channel; WAV data is
+ * deinterleaved when read and interleaved again when written.
  */
 class FileAudio : public Audio {
 private:
-    std::vector<sample> samples; ///< Buffer storing the audio samples.
+    SampleBuffer samples;        ///< Copy-on-write buffer storing the audio samples, shared between clones.
     size_t currentSize;          ///< The current number of samples stored in the buffer.
-    const char* fileName;        ///< The name of the file associated with this audio object.
-
-    /**
-     * @brief Writes an integer value to an output stream as a sequence of bytes.
-     * @param file The output stream to write to.
-     * @param value The integer value to write.
-     * @param byteSize The number of bytes to represent the integer.
-     */
-    static void writeAsBytes(std::ostream& file, int value, int byteSize);
+    std::string fileName;        ///< The file the samples were read from, empty once they no longer match it.
 
 public:
     /**
@@ -46,39 +43,75 @@ public:
      * @brief Constructs a FileAudio object from an existing Audio object.
      *
      * This effectively converts any Audio object into a FileAudio object,
-     * copying its samples and properties.
+     * copying its samples and properties. The sample range is split into chunks that
+     * are rendered in parallel on the shared `ThreadPool`, straight into the new planes;
+     * audio that is not random access is rendered sequentially instead. Blocks that
+     * `describeRegion()` reports as constant are filled without rendering.
      * @param existingAudio The Audio object to copy from.
      */
     FileAudio(const Audio& existingAudio);
 //    FileAudio(const std::string& fileName); // Commented out constructor, potentially for future use or replaced by char* version.
 
     /**
-     * @brief Accesses a sample at the given index (const version).
+     * @brief Accesses a sample of the first channel at the given index (const version).
      * @param index The index of the sample.
      * @return The value of the sample at the specified index.
      * @throws std::out_of_range if the index is invalid.
      */
-    double operator[](size_t index) const override;
+    sample operator[](size_t index) const override;
 
     /**
-     * @brief Accesses a sample at the given index (non-const version).
+     * @brief Accesses a sample of the first channel at the given index (non-const version).
+     *
+     * The reference may be kept and written through later: once it has been handed out,
+     * clones of this object copy the samples instead of sharing them, and the file they
+     * were read from no longer describes them.
      * @param index The index of the sample.
      * @return A reference to the sample at the specified index.
      * @throws std::out_of_range if the index is invalid.
      */
-    double &operator[](size_t index) override;
+    sample &operator[](size_t index) override;
+
+    /**
+     * @brief Renders a block of samples by copying directly from the channel planes.
+     * @param start The index of the first sample to render.
+     * @param count The number of samples to render per channel.
+     * @param out One destination plane per channel; samples past the end are written as silence.
+     */
+    void render(std::size_t start, std::size_t count, sample *const *out) const override;
+
+    /**
+     * @brief Gets the peak and RMS level of the samples.
+     *
+     * Computed once with a parallel scan of the sample buffer and cached in the buffer,
+     * shared with every clone, until the samples are modified or reloaded.
+     * @return The level statistics of the audio.
+     */
+    AudioStats analyze() const override;
+
+    /**
+     * @brief Describes the file the samples were read from.
+     * @param source Set to "FILE <path>" and the path, made canonical.
+     * @return True while the samples are as read from the file; false if they were modified
+     *         or the file is gone, or they did not come from a file.
+     */
+    bool getSource(AudioSource &source) const override;
 
     /**
      * @brief Clones the FileAudio object.
-     * @return A pointer to a new FileAudio object, which is a deep copy of this one.
+     *
+     * The clone shares the sample buffer, so this is O(1) regardless of length;
+     * the buffer is copied only if one of them is later modified, or right away if a
+     * sample reference was handed out by the non-const `operator[]`.
+     * @return A pointer to a new FileAudio object with the same samples.
      */
     FileAudio* clone() const override;
 
     /**
      * @brief Reads audio data from a text file.
      *
-     * The text file is expected to contain sample values, typically one per line or space-separated.
-     * Metadata like sample rate and duration might need to be set separately or inferred.
+     * The text file holds a "duration sampleRate sampleSize" header followed by whitespace-separated
+     * sample values. The file is memory-mapped and parsed in parallel chunks with `std::from_chars`.
      * @param fileName The path to the text file.
      */
     void readTXT(const char* fileName);
@@ -87,6 +120,7 @@ public:
      * @brief Reads audio data from a WAV file.
      *
      * Parses the WAV file header to set sample rate, duration, etc., and then loads the sample data.
+     * Supports 8/16/24/32-bit PCM and 32/64-bit float with any number of channels.
      * @param fileName The path to the WAV file.
      */
     void readWAV(const char* fileName);
@@ -94,8 +128,10 @@ public:
     /**
      * @brief Writes the audio data to a text file.
      *
-     * Samples are typically written one per line or space-separated.
+     * Samples are written space-separated in their shortest exactly round-trippable form,
+     * formatted in parallel with `std::to_chars`.
      * @param fileName The path to the text file to create/overwrite.
+     * @throws std::runtime_error if the audio has more than one channel, which the format cannot hold.
      */
     void writeTXT(const char* fileName) const;
 
@@ -103,15 +139,20 @@ public:
      * @brief Writes the audio data to a WAV file.
      *
      * Creates a WAV file with the appropriate header based on the audio properties
-     * and writes out the sample data.
+     * and encodes the channel planes block by block through a `WavWriter`.
      * @param fileName The path to the WAV file to create/overwrite.
+     * @param encoding PCM or float output.
+     * @param bitsPerSample 16, 24 or 32 for PCM; 32 for float.
+     * @param dither The rounding mode for PCM output.
      */
-    void writeWAV(const char* fileName) const;
+    void writeWAV(const char* fileName, WavEncoding encoding = WavEncoding::PCM, unsigned bitsPerSample = 16,
+                  WavDither dither = WavDither::None) const;
 
     /**
      * @brief Prints the audio data to an output stream.
      *
-     * This typically involves printing metadata and then the sample values.
+     * Prints the header and then the sample values, frames interleaved, in the round-trippable
+     * text form used by `writeTXT()`.
      * @param out The output stream.
      * @return A reference to the output stream.
      */
@@ -140,11 +181,27 @@ public:
      */
     FileAudioCreator();
 
+    /**
+     * @brief Reads the file name, so a live node for the file is found before it is loaded.
+     * @param in The input stream, positioned at the file name.
+     * @param parameters Receives the file name.
+     * @return True.
+     */
+    bool readParameters(std::istream &in, std::string &parameters) const override;
+
+    /**
+     * @brief Gets the version of the file, so a node made before the file changed is not reused.
+     * @param parameters The file name.
+     * @return The value of `fileVersion()` for the file.
+     */
+    std::string getVersion(const std::string &parameters) const override;
+
     /**
      * @brief Creates a FileAudio object from an input stream.
      *
      * This method might read a filename or initial command from the stream
-     * to determine how to load the FileAudio object.
+     * to determine how to load the FileAudio object. Files are loaded through the
+     * `SampleCache`, so loading an unchanged file again does not decode it.
      * @param in The input stream (e.g., representing console input or a script).
      * @return A pointer to the created FileAudio object.
      */
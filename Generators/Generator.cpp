@@ -1 +1,296 @@
 #include "Generator.hpp"
+#include "../Kernels.hpp"
+#include "../SampleBuffer.hpp"
+#include "../ThreadPool.hpp"
+#include <string>
+
+MixGenerator::MixGenerator(std::vector<std::shared_ptr<const Audio>> inputs, std::vector<double> gains)
+        : Audio(), inputs(std::move(inputs)) {
+    if (this->inputs.empty()) {
+        throw std::invalid_argument("MixGenerator needs at least one input");
+    }
+    if (!gains.empty() && gains.size() != this->inputs.size()) {
+        throw std::invalid_argument("MixGenerator has " + std::to_string(this->inputs.size()) + " inputs but "
+                                    + std::to_string(gains.size()) + " gains");
+    }
+    for (const auto &input : this->inputs) {
+        if (!input) {
+            throw std::invalid_argument("MixGenerator input is null");
+        }
+        if (input->getSampleRate() != this->inputs.front()->getSampleRate()) {
+            throw std::invalid_argument("MixGenerator inputs must share a sample rate");
+        }
+        this->sampleSize = std::max(this->sampleSize, input->getSampleSize());
+        this->channels = std::max(this->channels, input->getChannels());
+    }
+    this->gains.resize(this->inputs.size(), 1);
+    std::copy(gains.begin(), gains.end(), this->gains.begin());
+    this->sampleRate = this->inputs.front()->getSampleRate();
+    this->duration = static_cast<double>(this->sampleSize) / this->sampleRate;
+}
+
+void MixGenerator::accumulate(std::size_t first, std::size_t last, std::size_t start, std::size_t count,
+                              sample *const *accumulator, sample *const *scratch) const {
+    const KernelSet &kernels = activeKernels();
+    for (std::size_t i = first; i < last; ++i) {
+        const Audio &input = *this->inputs[i];
+        if (start >= input.getSampleSize()) {
+            continue; // Padded with silence
+        }
+        AudioRegion region = input.describeRegion(start, count);
+        if (region.isSilent()) {
+            continue;
+        }
+        if (region.constant) {
+            std::fill(scratch[0], scratch[0] + count, region.value);
+        } else {
+            input.render(start, count, scratch);
+        }
+        // A constant region has one value on every channel, so its first plane stands for all of them
+        bool shared = region.constant || input.getChannels() == 1;
+        unsigned fed = input.getChannels() == 1 ? this->channels : input.getChannels();
+        for (unsigned c = 0; c < fed; ++c) {
+            kernels.mulAdd(scratch[shared ? 0 : c], count, this->gains[i], accumulator[c]);
+        }
+    }
+}
+
+void MixGenerator::render(std::size_t start, std::size_t count, sample *const *out) const {
+    const KernelSet &kernels = activeKernels();
+    unsigned channels = this->channels;
+    std::size_t groups = (this->inputs.size() + inputsPerGroup - 1) / inputsPerGroup;
+    for (unsigned c = 0; c < channels; ++c) {
+        std::fill(out[c], out[c] + count, 0.0);
+    }
+
+    // One accumulator and one scratch block per group; a single group accumulates straight into `out`
+    std::size_t frames = std::min(count, Audio::blockSize);
+    PlanarBlock scratch(static_cast<unsigned>(groups * channels), frames);
+    PlanarBlock partials(static_cast<unsigned>(groups > 1 ? groups * channels : 0), frames);
+    std::vector<sample *> target(channels);
+
+    for (std::size_t pos = 0; pos < count; pos += Audio::blockSize) {
+        std::size_t n = std::min(Audio::blockSize, count - pos);
+        for (unsigned c = 0; c < channels; ++c) {
+            target[c] = out[c] + pos;
+        }
+        if (groups == 1) {
+            this->accumulate(0, this->inputs.size(), start + pos, n, target.data(), scratch.planes());
+            continue;
+        }
+        ThreadPool::getInstance().parallelFor(0, groups, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t g = begin; g < end; ++g) {
+                sample *const *partial = partials.planes() + g * channels;
+                for (unsigned c = 0; c < channels; ++c) {
+                    std::fill(partial[c], partial[c] + n, 0.0);
+                }
+                std::size_t last = std::min(this->inputs.size(), (g + 1) * inputsPerGroup);
+                this->accumulate(g * inputsPerGroup, last, start + pos, n, partial,
+                                 scratch.planes() + g * channels);
+            }
+        });
+        // Combine in group order so the sum does not depend on scheduling
+        for (std::size_t g = 0; g < groups; ++g) {
+            for (unsigned c = 0; c < channels; ++c) {
+                kernels.mulAdd(partials[static_cast<unsigned>(g * channels + c)], n, 1, target[c]);
+            }
+        }
+    }
+}
+
+AudioRegion MixGenerator::describeRegion(std::size_t start, std::size_t count) const {
+    if (start >= this->sampleSize) {
+        return Audio::describeRegion(start, count);
+    }
+    // Sum the constants in the same order as render() so both agree exactly
+    AudioRegion mix;
+    sample group = 0;
+    for (std::size_t i = 0; i < this->inputs.size(); ++i) {
+        const Audio &input = *this->inputs[i];
+        if (start < input.getSampleSize()) {
+            AudioRegion region = input.describeRegion(start, count);
+            bool fillsAll = input.getChannels() == 1 || input.getChannels() == this->channels;
+            if (!region.constant || (!fillsAll && region.value != 0)) {
+                return AudioRegion();
+            }
+            if (region.value != 0) {
+                group += region.value * this->gains[i];
+            }
+        }
+        if ((i + 1) % inputsPerGroup == 0 || i + 1 == this->inputs.size()) {
+            mix.value += group;
+            group = 0;
+        }
+    }
+    mix.constant = true;
+    return mix;
+}
+
+sample MixGenerator::operator[](std::size_t i) const {
+    sample mix = 0;
+    sample group = 0;
+    for (std::size_t k = 0; k < this->inputs.size(); ++k) {
+        if (i < this->inputs[k]->getSampleSize()) {
+            sample value = (*this->inputs[k])[i];
+            if (value != 0) {
+                group += value * this->gains[k];
+            }
+        }
+        if ((k + 1) % inputsPerGroup == 0 || k + 1 == this->inputs.size()) {
+            mix += group;
+            group = 0;
+        }
+    }
+    return mix;
+}
+
+sample &MixGenerator::operator[](std::size_t /*i*/) {
+    throw std::logic_error("MixGenerator does not support sample modification.");
+}
+
+bool MixGenerator::isRandomAccess() const {
+    return std::all_of(this->inputs.begin(), this->inputs.end(),
+                       [](const std::shared_ptr<const Audio> &input) { return input->isRandomAccess(); });
+}
+
+MixGenerator *MixGenerator::clone() const {
+    return new MixGenerator(*this);
+}
+
+std::ostream &MixGenerator::printToStream(std::ostream &out) const {
+    out << "MixGenerator: " << this->inputs.size() << " inputs, " << this->sampleSize << " samples x "
+        << this->channels << " channels @ " << this->sampleRate << "Hz\n";
+    return out;
+}
+
+RepeatGenerator::RepeatGenerator(std::shared_ptr<const Audio> source, std::size_t repeats, std::size_t crossfade)
+        : Audio(), source(std::move(source)), repeats(repeats), crossfade(crossfade), period(0) {
+    if (!this->source || this->source->getSampleSize() == 0) {
+        throw std::invalid_argument("RepeatGenerator needs a non-empty source");
+    }
+    if (!this->source->isRandomAccess()) {
+        throw std::invalid_argument("RepeatGenerator needs a random access source");
+    }
+    if (repeats == 0) {
+        throw std::invalid_argument("RepeatGenerator needs at least one repeat");
+    }
+    std::size_t length = this->source->getSampleSize();
+    if (crossfade > length / 2) {
+        throw std::invalid_argument("RepeatGenerator crossfade of " + std::to_string(crossfade)
+                                    + " samples is longer than half the source");
+    }
+    this->period = length - crossfade;
+    this->channels = this->source->getChannels();
+    this->sampleRate = this->source->getSampleRate();
+    this->sampleSize = repeats * this->period + crossfade;
+    this->duration = static_cast<double>(this->sampleSize) / this->sampleRate;
+
+    // Mix the seam once: the tail of the source fades out while its head fades in
+    auto seam = std::make_shared<PlanarBlock>(this->channels, crossfade);
+    PlanarBlock head(this->channels, crossfade);
+    if (crossfade > 0) {
+        this->source->render(this->period, crossfade, seam->planes());
+        this->source->render(0, crossfade, head.planes());
+    }
+    for (unsigned c = 0; c < this->channels; ++c) {
+        for (std::size_t j = 0; j < crossfade; ++j) {
+            double fadeIn = static_cast<double>(j + 1) / static_cast<double>(crossfade + 1);
+            (*seam)[c][j] = static_cast<sample>((*seam)[c][j] * (1.0 - fadeIn) + head[c][j] * fadeIn);
+        }
+    }
+    this->seam = std::move(seam);
+}
+
+bool RepeatGenerator::locate(std::size_t index, std::size_t &sourceStart, std::size_t &length) const {
+    std::size_t iteration = index / this->period;
+    std::size_t offset = index % this->period;
+    if (iteration == this->repeats) { // Inside the final tail
+        sourceStart = this->period + offset;
+        length = this->crossfade - offset;
+        return false;
+    }
+    if (iteration > 0 && offset < this->crossfade) {
+        sourceStart = offset;
+        length = this->crossfade - offset;
+        return true;
+    }
+    sourceStart = offset;
+    // The last iteration runs on into its tail, which is contiguous in the source
+    length = (iteration + 1 == this->repeats ? this->source->getSampleSize() : this->period) - offset;
+    return false;
+}
+
+sample RepeatGenerator::operator[](std::size_t i) const {
+    if (i >= this->sampleSize) {
+        return 0;
+    }
+    std::size_t from;
+    std::size_t length;
+    if (this->locate(i, from, length)) {
+        return (*this->seam)[0][from];
+    }
+    return (*this->source)[from];
+}
+
+sample &RepeatGenerator::operator[](std::size_t /*i*/) {
+    throw std::logic_error("RepeatGenerator does not support sample modification.");
+}
+
+void RepeatGenerator::render(std::size_t start, std::size_t count, sample *const *out) const {
+    unsigned channels = this->channels;
+    std::size_t available = (start < this->sampleSize) ? std::min(count, this->sampleSize - start) : 0;
+    std::vector<sample *> planes(channels);
+    std::size_t length = 0;
+    for (std::size_t pos = 0; pos < available; pos += length) {
+        std::size_t from;
+        bool inSeam = this->locate(start + pos, from, length);
+        length = std::min(length, available - pos);
+        if (inSeam) {
+            for (unsigned c = 0; c < channels; ++c) {
+                std::copy((*this->seam)[c] + from, (*this->seam)[c] + from + length, out[c] + pos);
+            }
+        } else {
+            for (unsigned c = 0; c < channels; ++c) {
+                planes[c] = out[c] + pos;
+            }
+            this->source->render(from, length, planes.data());
+        }
+    }
+    for (unsigned c = 0; c < channels; ++c) {
+        std::fill(out[c] + available, out[c] + count, 0.0);
+    }
+}
+
+AudioRegion RepeatGenerator::describeRegion(std::size_t start, std::size_t count) const {
+    if (start >= this->sampleSize) {
+        return Audio::describeRegion(start, count);
+    }
+    std::size_t from;
+    std::size_t length;
+    bool inSeam = this->locate(start, from, length);
+    std::size_t inside = std::min(count, this->sampleSize - start);
+    AudioRegion region;
+    if (!inSeam && inside <= length) {
+        region = this->source->describeRegion(from, inside);
+    } else if (!this->source->describeRegion(0, this->source->getSampleSize()).isSilent()) {
+        return AudioRegion(); // Spans pieces of a source that is not silent throughout
+    } else {
+        region.constant = true;
+    }
+    // Past the end the loop is silent, which only continues a silent region
+    if (inside < count && !region.isSilent()) {
+        return AudioRegion();
+    }
+    return region;
+}
+
+RepeatGenerator *RepeatGenerator::clone() const {
+    return new RepeatGenerator(*this);
+}
+
+std::ostream &RepeatGenerator::printToStream(std::ostream &out) const {
+    out << "RepeatGenerator: " << this->repeats << " x " << this->source->getSampleSize() << " samples, "
+        << this->crossfade << " sample crossfade, " << this->sampleSize << " samples x " << this->channels
+        << " channels @ " << this->sampleRate << "Hz\n";
+    return out;
+}
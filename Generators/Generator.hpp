@@ -9,25 +9,188 @@
 #include "../Audio.hpp"
 #include <cmath> // For std::sin
 #include <stdexcept> // For std::logic_error
+#include <algorithm> // For std::min, std::fill
+#include <memory> // For std::shared_ptr
+#include <type_traits> // For std::void_t
+#include <utility> // For std::move
+#include <vector> // For std::vector
 
 /**
- * @brief Placeholder for a mix generator operation.
- * @note This struct is currently empty and needs implementation.
+ * @brief Mixes any number of audio inputs, each with its own gain.
+ *
+ * Inputs are summed one block at a time into the destination planes with the vectorized
+ * `mulAdd` kernel while the block is cache resident. Inputs shorter than the mix are padded
+ * with silence, and blocks an input reports as silent are skipped. Mono inputs feed every
+ * channel; other inputs feed the channels they have. Large mixes are split into fixed groups
+ * of inputs that are summed in parallel and then combined in group order, so the result does
+ * not depend on the number of threads.
  */
-struct MixGenerator{
-    // TODO: Implement MixGenerator functionality.
-    // It should likely take two or more audio sources (or generators)
-    // and combine their output sample by sample.
+class MixGenerator : public Audio {
+private:
+    std::vector<std::shared_ptr<const Audio>> inputs; ///< The mixed inputs.
+    std::vector<sample> gains;                         ///< The gain of each input.
+
+    /**
+     * @brief Adds a group of inputs over one block into accumulator planes.
+     * @param first The first input of the group.
+     * @param last One past the last input of the group.
+     * @param start The index of the first sample of the block.
+     * @param count The number of samples in the block.
+     * @param accumulator One plane per channel to add into.
+     * @param scratch Planes with room for `count` samples of the widest input.
+     */
+    void accumulate(std::size_t first, std::size_t last, std::size_t start, std::size_t count,
+                    sample *const *accumulator, sample *const *scratch) const;
+
+public:
+    /// @brief Inputs per parallel summing group; fixed so that results do not depend on the thread count.
+    static constexpr std::size_t inputsPerGroup = 32;
+
+    /**
+     * @brief Constructs a mix of the given inputs.
+     *
+     * The mix has the sample rate of its inputs, the largest of their channel counts and the
+     * length of the longest one.
+     * @param inputs The inputs to mix. Must not be empty or contain nulls, and must share a sample rate.
+     * @param gains The gain of each input, or empty for unity gain on every input.
+     * @throws std::invalid_argument if the inputs or gains are invalid.
+     */
+    explicit MixGenerator(std::vector<std::shared_ptr<const Audio>> inputs, std::vector<double> gains = {});
+
+    /**
+     * @brief Computes a mixed sample of the first channel.
+     * @param i The sample index.
+     * @return The gain-weighted sum of the inputs at index `i`.
+     */
+    sample operator[](std::size_t i) const override;
+
+    /**
+     * @brief Accesses a sample (non-const version).
+     * @throws std::logic_error as mixes are immutable once created.
+     * @param i The sample index (unused).
+     * @return A reference to a sample (never actually returns due to exception).
+     */
+    sample &operator[](std::size_t i) override;
+
+    /**
+     * @brief Renders the mix of a block of every channel.
+     * @param start The index of the first sample to render.
+     * @param count The number of samples to render per channel.
+     * @param out One destination plane per channel; samples past the end are written as silence.
+     */
+    void render(std::size_t start, std::size_t count, sample *const *out) const override;
+
+    /**
+     * @brief Describes a range of the mix from its inputs.
+     * @param start The index of the first sample of the range.
+     * @param count The number of samples in the range.
+     * @return A constant region if every input is constant over the range, otherwise an unknown one.
+     */
+    AudioRegion describeRegion(std::size_t start, std::size_t count) const override;
+
+    /**
+     * @brief Checks whether every input can be rendered in any order.
+     * @return True if all inputs are random access.
+     */
+    bool isRandomAccess() const override;
+
+    /**
+     * @brief Clones the MixGenerator object.
+     * @return A pointer to a new MixGenerator sharing the same inputs.
+     */
+    MixGenerator *clone() const override;
+
+    /**
+     * @brief Prints a summary of the mix to an output stream.
+     * @param out The output stream.
+     * @return A reference to the output stream.
+     */
+    std::ostream &printToStream(std::ostream &out) const override;
 };
 
+class PlanarBlock;
+
 /**
- * @brief Placeholder for a repeat generator operation.
- * @note This struct is currently empty and needs implementation.
+ * @brief Loops one shared copy of a source a number of times.
+ *
+ * Output indices are mapped back into the source with modular arithmetic, so a long loop-based
+ * arrangement costs the memory of a single loop. Rendering splits each request at loop
+ * boundaries and renders every piece as one contiguous range of the source.
+ *
+ * With a crossfade of `X` samples, each seam overlaps the last `X` samples of one iteration with
+ * the first `X` samples of the next under linear fades. The seam is mixed once at construction.
+ * Iterations then advance by `source length - X`, and the final iteration plays its tail unfaded.
  */
-struct RepeatGenerator{
-    // TODO: Implement RepeatGenerator functionality.
-    // It should likely take an audio segment (or another generator's output for a duration)
-    // and repeat it a certain number of times or for a total duration.
+class RepeatGenerator : public Audio {
+private:
+    std::shared_ptr<const Audio> source;          ///< The looped source.
+    std::size_t repeats;                          ///< The number of iterations.
+    std::size_t crossfade;                        ///< The seam length in samples.
+    std::size_t period;                           ///< The distance between iteration starts, in samples.
+    std::shared_ptr<const PlanarBlock> seam;      ///< The precomputed seam, one plane per channel.
+
+    /**
+     * @brief Maps an output index to the piece of the timeline containing it.
+     * @param index The output index. Must be below the sample size.
+     * @param sourceStart Set to the matching source index, or to the seam offset for seams.
+     * @param length Set to the number of samples left in the piece from `index`.
+     * @return True if the index lies in a crossfaded seam.
+     */
+    bool locate(std::size_t index, std::size_t &sourceStart, std::size_t &length) const;
+
+public:
+    /**
+     * @brief Constructs a loop of a source.
+     * @param source The audio to loop. Must be random access and not empty.
+     * @param repeats The number of iterations. Must be at least one.
+     * @param crossfade The seam length in samples. Must be at most half the source length.
+     * @throws std::invalid_argument if the arguments are invalid.
+     */
+    RepeatGenerator(std::shared_ptr<const Audio> source, std::size_t repeats, std::size_t crossfade = 0);
+
+    /**
+     * @brief Gets a looped sample of the first channel.
+     * @param i The sample index.
+     * @return The sample, or 0 past the end.
+     */
+    sample operator[](std::size_t i) const override;
+
+    /**
+     * @brief Accesses a sample (non-const version).
+     * @throws std::logic_error as loops are immutable once created.
+     * @param i The sample index (unused).
+     * @return A reference to a sample (never actually returns due to exception).
+     */
+    sample &operator[](std::size_t i) override;
+
+    /**
+     * @brief Renders a block of every channel from the source and the seam.
+     * @param start The index of the first sample to render.
+     * @param count The number of samples to render per channel.
+     * @param out One destination plane per channel; samples past the end are written as silence.
+     */
+    void render(std::size_t start, std::size_t count, sample *const *out) const override;
+
+    /**
+     * @brief Describes a range by forwarding it to the source where it maps to a single piece.
+     * @param start The index of the first sample of the range.
+     * @param count The number of samples in the range.
+     * @return The source's description of the matching range, or an unknown region.
+     */
+    AudioRegion describeRegion(std::size_t start, std::size_t count) const override;
+
+    /**
+     * @brief Clones the RepeatGenerator object.
+     * @return A pointer to a new RepeatGenerator sharing the same source and seam.
+     */
+    RepeatGenerator *clone() const override;
+
+    /**
+     * @brief Prints a summary of the loop to an output stream.
+     * @param out The output stream.
+     * @return A reference to the output stream.
+     */
+    std::ostream &printToStream(std::ostream &out) const override;
 };
 
 /**
@@ -48,10 +211,78 @@ struct SineGenerator {
      * @note Uses a common approximation for PI.
      */
     sample operator()(std::size_t i) const {
-        return std::sin(2 * 3.14159265358979323846 * frequency * static_cast<double>(i) / rate);
+        return static_cast<sample>(std::sin(phase(i)));
+    }
+
+    /**
+     * @brief Generates a block of the sine wave with a rotating phasor.
+     *
+     * Eight interleaved lanes each advance by a rotation of eight sample steps, so the loop
+     * vectorizes; every `resyncInterval` samples the phasor is reset from `std::sin`/`std::cos`
+     * of the exact phase, which bounds the drift of the recurrence and renormalizes it.
+     * In double precision the error against the exact sine is below 2e-12 plus the rounding
+     * of the phase argument (about |phase| * 2^-52, e.g. 2e-9 after an hour at 440 Hz), the
+     * same bound that applies to `operator()`. Any start index may be used.
+     * @param out The destination for `count` samples.
+     * @param start The index of the first sample.
+     * @param count The number of samples to generate.
+     */
+    void generate(sample *out, std::size_t start, std::size_t count) const {
+        constexpr std::size_t lanes = 8;
+        constexpr std::size_t resyncInterval = 256; // A multiple of the lane count
+        const double step = phase(1);
+        const double laneCos = std::cos(lanes * step); // Advances every lane by `lanes` samples
+        const double laneSin = std::sin(lanes * step);
+        const double stepCos = std::cos(step);
+        const double stepSin = std::sin(step);
+
+        for (std::size_t pos = 0; pos < count; pos += resyncInterval) {
+            std::size_t n = std::min(resyncInterval, count - pos);
+            double c[lanes], s[lanes];
+            c[0] = std::cos(phase(start + pos));
+            s[0] = std::sin(phase(start + pos));
+            for (std::size_t j = 1; j < lanes; ++j) {
+                c[j] = c[j - 1] * stepCos - s[j - 1] * stepSin;
+                s[j] = s[j - 1] * stepCos + c[j - 1] * stepSin;
+            }
+            sample *block = out + pos;
+            std::size_t k = 0;
+            for (; k + lanes <= n; k += lanes) {
+                for (std::size_t j = 0; j < lanes; ++j) {
+                    block[k + j] = static_cast<sample>(s[j]);
+                    double rotated = c[j] * laneCos - s[j] * laneSin;
+                    s[j] = s[j] * laneCos + c[j] * laneSin;
+                    c[j] = rotated;
+                }
+            }
+            for (std::size_t j = 0; k + j < n; ++j) {
+                block[k + j] = static_cast<sample>(s[j]);
+            }
+        }
+    }
+
+private:
+    /**
+     * @brief Computes the phase of a sample.
+     * @param i The sample index.
+     * @return The phase in radians.
+     */
+    double phase(std::size_t i) const {
+        return 2 * 3.14159265358979323846 * frequency * static_cast<double>(i) / rate;
     }
 };
 
+/**
+ * @brief Detects generators that provide a block `generate(out, start, count)` method.
+ * @tparam Generator The generator functor type.
+ */
+template<typename Generator, typename = void>
+struct HasBlockGenerate : std::false_type {};
+
+template<typename Generator>
+struct HasBlockGenerate<Generator, std::void_t<decltype(std::declval<const Generator &>().generate(
+        std::declval<sample *>(), std::size_t{}, std::size_t{}))>> : std::true_type {};
+
 /**
  * @brief Template class for audio generated by a specific generator operation.
  *
@@ -73,9 +304,9 @@ public:
      * @brief Constructs a GeneratorAudio object.
      * @param rate The sample rate in Hz.
      * @param dur The duration of the audio in seconds.
-     * @param gen The generator functor instance.
+     * @param gen The generator functor instance, moved into the GeneratorAudio.
      */
-    GeneratorAudio(float rate, double dur, const Generator &gen);
+    GeneratorAudio(float rate, double dur, Generator gen);
 
     /**
      * @brief Clones the GeneratorAudio object.
@@ -91,7 +322,7 @@ public:
      * @param i The sample index.
      * @return The value of the generated sample at index `i`.
      */
-    double operator[](std::size_t i) const override;
+    sample operator[](std::size_t i) const override;
 
     /**
      * @brief Accesses a sample (non-const version).
@@ -99,7 +330,17 @@ public:
      * @param i The sample index (unused).
      * @return A reference to a sample (never actually returns due to exception).
      */
-    double &operator[](std::size_t i) override;
+    sample &operator[](std::size_t i) override;
+
+    /**
+     * @brief Renders a block of generated samples with the generator's block method or functor.
+     *
+     * Generated audio is mono, so only the first plane is written.
+     * @param start The index of the first sample to render.
+     * @param count The number of samples to render.
+     * @param out The destination plane; samples past the end are written as silence.
+     */
+    void render(std::size_t start, std::size_t count, sample *const *out) const override;
 
     /**
      * @brief Prints information about the generated audio to an output stream.
@@ -130,7 +371,7 @@ std::ostream &GeneratorAudio<Generator>::printToStream(std::ostream &out) const
  * @return A reference to a double (never actually returns due to exception).
  */
 template<typename Generator>
-double &GeneratorAudio<Generator>::operator[](std::size_t /*i*/) { // Marked i as unused
+sample &GeneratorAudio<Generator>::operator[](std::size_t /*i*/) { // Marked i as unused
     throw std::logic_error("GeneratorAudio does not support sample modification.");
 }
 
@@ -144,9 +385,34 @@ double &GeneratorAudio<Generator>::operator[](std::size_t /*i*/) { // Marked i a
  * @return The generated sample value, or 0.0 if out of bounds.
  */
 template<typename Generator>
-double GeneratorAudio<Generator>::operator[](std::size_t i) const {
+sample GeneratorAudio<Generator>::operator[](std::size_t i) const {
     // Accessing protected member sampleSize from base class Audio
-    return (i < this->getSampleSize()) ? generator(i) : 0.0;
+    return (i < this->getSampleSize()) ? generator(i) : sample(0);
+}
+
+/**
+ * @brief Implementation of the block render for GeneratorAudio.
+ *
+ * Uses the generator's block `generate()` method when it has one, otherwise evaluates the
+ * generator functor in a tight loop without per-sample virtual dispatch.
+ * @tparam Generator The type of the generator functor.
+ * @param start The index of the first sample to render.
+ * @param count The number of samples to render.
+ * @param out The destination plane.
+ */
+template<typename Generator>
+void GeneratorAudio<Generator>::render(std::size_t start, std::size_t count, sample *const *out) const {
+    std::size_t size = this->getSampleSize();
+    std::size_t available = (start < size) ? std::min(count, size - start) : 0;
+    sample *plane = out[0];
+    if constexpr (HasBlockGenerate<Generator>::value) {
+        generator.generate(plane, start, available);
+    } else {
+        for (std::size_t k = 0; k < available; ++k) {
+            plane[k] = generator(start + k);
+        }
+    }
+    std::fill(plane + available, plane + count, 0.0);
 }
 
 /**
@@ -157,10 +423,10 @@ double GeneratorAudio<Generator>::operator[](std::size_t i) const {
  * @tparam Generator The type of the generator functor.
  * @param rate The sample rate in Hz.
  * @param dur The duration in seconds.
- * @param gen The generator functor instance.
+ * @param gen The generator functor instance, moved into the GeneratorAudio.
  */
 template<typename Generator>
-GeneratorAudio<Generator>::GeneratorAudio(float rate, double dur, const Generator &gen) : generator(gen) {
+GeneratorAudio<Generator>::GeneratorAudio(float rate, double dur, Generator gen) : generator(std::move(gen)) {
     setSampleRate(rate);
     setDuration(dur);
     // Calculate sampleSize based on rate and duration
@@ -0,0 +1,123 @@
+#include "Hash.hpp"
+#include "MappedFile.hpp"
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <sys/stat.h>
+
+static constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+static constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr std::uint64_t prime3 = 0x165667B19E3779F9ULL;
+static constexpr std::uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr std::uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+static inline std::uint64_t rotateLeft(std::uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline std::uint64_t read64(const unsigned char *p) {
+    std::uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline std::uint32_t read32(const unsigned char *p) {
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline std::uint64_t round64(std::uint64_t accumulator, std::uint64_t input) {
+    return rotateLeft(accumulator + input * prime2, 31) * prime1;
+}
+
+static inline std::uint64_t merge64(std::uint64_t accumulator, std::uint64_t lane) {
+    return (accumulator ^ round64(0, lane)) * prime1 + prime4;
+}
+
+std::uint64_t hashBytes(const void *data, std::size_t size, std::uint64_t seed) {
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    const unsigned char *end = p + size;
+    std::uint64_t hash;
+
+    if (size >= 32) {
+        // Four independent lanes keep the multipliers busy
+        std::uint64_t v1 = seed + prime1 + prime2;
+        std::uint64_t v2 = seed + prime2;
+        std::uint64_t v3 = seed;
+        std::uint64_t v4 = seed - prime1;
+        const unsigned char *limit = end - 32;
+        do {
+            v1 = round64(v1, read64(p));
+            v2 = round64(v2, read64(p + 8));
+            v3 = round64(v3, read64(p + 16));
+            v4 = round64(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+        hash = merge64(hash, v1);
+        hash = merge64(hash, v2);
+        hash = merge64(hash, v3);
+        hash = merge64(hash, v4);
+    } else {
+        hash = seed + prime5;
+    }
+    hash += static_cast<std::uint64_t>(size);
+
+    for (; p + 8 <= end; p += 8) {
+        hash = rotateLeft(hash ^ round64(0, read64(p)), 27) * prime1 + prime4;
+    }
+    if (p + 4 <= end) {
+        hash = rotateLeft(hash ^ (static_cast<std::uint64_t>(read32(p)) * prime1), 23) * prime2 + prime3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        hash = rotateLeft(hash ^ (*p * prime5), 11) * prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+/**
+ * @brief A cached file hash and the file state it was computed for.
+ */
+struct FileHashEntry {
+    std::uint64_t size;          ///< The file size in bytes.
+    std::int64_t modifiedSec;    ///< The modification time, seconds part.
+    std::int64_t modifiedNsec;   ///< The modification time, nanoseconds part.
+    std::uint64_t hash;          ///< The hash of the contents.
+};
+
+std::uint64_t hashFile(const char *fileName) {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, FileHashEntry> cache;
+
+    struct stat info{};
+    if (!fileName || ::stat(fileName, &info) != 0) {
+        throw std::runtime_error("Failed to stat file: " + std::string(fileName ? fileName : "")
+                                 + " (" + std::strerror(errno) + ")");
+    }
+    FileHashEntry entry{static_cast<std::uint64_t>(info.st_size), static_cast<std::int64_t>(info.st_mtim.tv_sec),
+                        static_cast<std::int64_t>(info.st_mtim.tv_nsec), 0};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = cache.find(fileName);
+        if (found != cache.end() && found->second.size == entry.size
+            && found->second.modifiedSec == entry.modifiedSec && found->second.modifiedNsec == entry.modifiedNsec) {
+            return found->second.hash;
+        }
+    }
+    MappedFile file(fileName);
+    entry.hash = hashBytes(file.data(), file.size());
+    std::lock_guard<std::mutex> lock(mutex);
+    cache[fileName] = entry;
+    return entry.hash;
+}
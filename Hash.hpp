@@ -0,0 +1,35 @@
+/**
+ * @file Hash.hpp
+ * @brief Declares the 64-bit content hashes used to identify sample data and referenced files.
+ */
+
+#ifndef DAW_HASH_HPP
+#define DAW_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Hashes a byte range with the XXH64 algorithm.
+ *
+ * Runs at several bytes per cycle. Longer data can be hashed piece by piece by passing
+ * the hash of the previous piece as the seed of the next.
+ * @param data The bytes to hash.
+ * @param size The number of bytes.
+ * @param seed The seed, or the hash of the preceding data.
+ * @return The 64-bit hash.
+ */
+std::uint64_t hashBytes(const void *data, std::size_t size, std::uint64_t seed = 0);
+
+/**
+ * @brief Hashes the contents of a file.
+ *
+ * The file is mapped rather than read. Results are cached per path, size and modification
+ * time, so rehashing an unchanged file costs one `stat()`.
+ * @param fileName The path of the file.
+ * @return The hash of the file contents.
+ * @throws std::runtime_error if the file cannot be opened.
+ */
+std::uint64_t hashFile(const char *fileName);
+
+#endif //DAW_HASH_HPP
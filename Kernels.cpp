@@ -0,0 +1,997 @@
+#include "Kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <random>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DAW_X86_KERNELS 1
+// GCC 12's AVX-512 intrinsics start from _mm512_undefined_*() and so trip -Wuninitialized when inlined
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#endif
+
+// mulAdd and quantize must round the product before adding on every path, so keep GCC from fusing it into an FMA
+#if defined(__GNUC__) && !defined(__clang__)
+#define DAW_NO_CONTRACT __attribute__((optimize("fp-contract=off")))
+#else
+#define DAW_NO_CONTRACT
+#endif
+
+// Scalar reference kernels
+
+static void scaleScalar(sample *data, std::size_t count, sample gain) {
+    for (std::size_t k = 0; k < count; ++k) {
+        data[k] *= gain;
+    }
+}
+
+static void rampScalar(sample *data, std::size_t count, sample first, sample step, sample divisor) {
+    for (std::size_t k = 0; k < count; ++k) {
+        data[k] *= (first + step * static_cast<sample>(k)) / divisor;
+    }
+}
+
+static sample peakScalar(const sample *data, std::size_t count) {
+    sample maxAmp = 0;
+    for (std::size_t k = 0; k < count; ++k) {
+        sample a = std::abs(data[k]);
+        if (a > maxAmp) maxAmp = a;
+    }
+    return maxAmp;
+}
+
+static double sumSquaresScalar(const sample *data, std::size_t count) {
+    double sum = 0.0;
+    for (std::size_t k = 0; k < count; ++k) {
+        sum += static_cast<double>(data[k]) * data[k];
+    }
+    return sum;
+}
+
+static void int16ToSampleScalar(const unsigned char *in, std::size_t count, sample *out) {
+    const sample scale = sample(1) / sample(32768);
+    for (std::size_t k = 0; k < count; ++k) {
+        std::int16_t value;
+        std::memcpy(&value, in + 2 * k, 2);
+        out[k] = static_cast<sample>(value) * scale;
+    }
+}
+
+static void int32ToSampleScalar(const unsigned char *in, std::size_t count, sample *out) {
+    const sample scale = sample(1) / sample(2147483648.0);
+    for (std::size_t k = 0; k < count; ++k) {
+        std::int32_t value;
+        std::memcpy(&value, in + 4 * k, 4);
+        out[k] = static_cast<sample>(value) * scale;
+    }
+}
+
+DAW_NO_CONTRACT
+static void quantizeScalar(const sample *in, std::size_t count, sample scale, sample lower, sample upper,
+                           const sample *dither, std::int32_t *out) {
+    for (std::size_t k = 0; k < count; ++k) {
+        sample v = in[k] * scale;
+        if (dither) v += dither[k];
+        v = (v > lower) ? v : lower; // Same operand order as the SIMD max/min, so NaN becomes lower
+        v = (v < upper) ? v : upper;
+        out[k] = static_cast<std::int32_t>(std::lrint(v));
+    }
+}
+
+DAW_NO_CONTRACT
+static void mulAddScalar(const sample *in, std::size_t count, sample gain, sample *out) {
+    for (std::size_t k = 0; k < count; ++k) {
+        out[k] += in[k] * gain;
+    }
+}
+
+#ifdef DAW_X86_KERNELS
+#ifndef DAW_SAMPLE_FLOAT
+
+// SSE2 kernels (double samples)
+
+__attribute__((target("sse2")))
+static void scaleSSE2(sample *data, std::size_t count, sample gain) {
+    const __m128d g = _mm_set1_pd(gain);
+    std::size_t k = 0;
+    for (; k + 2 <= count; k += 2) {
+        _mm_storeu_pd(data + k, _mm_mul_pd(_mm_loadu_pd(data + k), g));
+    }
+    scaleScalar(data + k, count - k, gain);
+}
+
+__attribute__((target("sse2")))
+static void rampSSE2(sample *data, std::size_t count, sample first, sample step, sample divisor) {
+    const __m128d d = _mm_set1_pd(divisor);
+    const __m128d inc = _mm_set1_pd(2.0 * step);
+    __m128d pos = _mm_set_pd(first + step, first);
+    std::size_t k = 0;
+    for (; k + 2 <= count; k += 2) {
+        _mm_storeu_pd(data + k, _mm_mul_pd(_mm_loadu_pd(data + k), _mm_div_pd(pos, d)));
+        pos = _mm_add_pd(pos, inc);
+    }
+    rampScalar(data + k, count - k, first + step * static_cast<sample>(k), step, divisor);
+}
+
+__attribute__((target("sse2")))
+static sample peakSSE2(const sample *data, std::size_t count) {
+    const __m128d absMask = _mm_castsi128_pd(_mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    __m128d m0 = _mm_setzero_pd();
+    __m128d m1 = _mm_setzero_pd();
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        m0 = _mm_max_pd(m0, _mm_and_pd(_mm_loadu_pd(data + k), absMask));
+        m1 = _mm_max_pd(m1, _mm_and_pd(_mm_loadu_pd(data + k + 2), absMask));
+    }
+    m0 = _mm_max_pd(m0, m1);
+    double lanes[2];
+    _mm_storeu_pd(lanes, m0);
+    double maxAmp = lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+    double tail = peakScalar(data + k, count - k);
+    return tail > maxAmp ? tail : maxAmp;
+}
+
+__attribute__((target("sse2")))
+static double sumSquaresSSE2(const sample *data, std::size_t count) {
+    __m128d s0 = _mm_setzero_pd();
+    __m128d s1 = _mm_setzero_pd();
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m128d a = _mm_loadu_pd(data + k);
+        __m128d b = _mm_loadu_pd(data + k + 2);
+        s0 = _mm_add_pd(s0, _mm_mul_pd(a, a));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(b, b));
+    }
+    s0 = _mm_add_pd(s0, s1);
+    double lanes[2];
+    _mm_storeu_pd(lanes, s0);
+    return lanes[0] + lanes[1] + sumSquaresScalar(data + k, count - k);
+}
+
+__attribute__((target("sse2")))
+static void int16ToSampleSSE2(const unsigned char *in, std::size_t count, sample *out) {
+    const __m128d scale = _mm_set1_pd(1.0 / 32768.0);
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(in + 2 * k));
+        __m128i wide = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        _mm_storeu_pd(out + k, _mm_mul_pd(_mm_cvtepi32_pd(wide), scale));
+        _mm_storeu_pd(out + k + 2, _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(wide, 8)), scale));
+    }
+    int16ToSampleScalar(in + 2 * k, count - k, out + k);
+}
+
+__attribute__((target("sse2")))
+static void int32ToSampleSSE2(const unsigned char *in, std::size_t count, sample *out) {
+    const __m128d scale = _mm_set1_pd(1.0 / 2147483648.0);
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 4 * k));
+        _mm_storeu_pd(out + k, _mm_mul_pd(_mm_cvtepi32_pd(v), scale));
+        _mm_storeu_pd(out + k + 2, _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(v, 8)), scale));
+    }
+    int32ToSampleScalar(in + 4 * k, count - k, out + k);
+}
+
+__attribute__((target("sse2")))
+DAW_NO_CONTRACT
+static void quantizeSSE2(const sample *in, std::size_t count, sample scale, sample lower, sample upper,
+                         const sample *dither, std::int32_t *out) {
+    const __m128d s = _mm_set1_pd(scale);
+    const __m128d lo = _mm_set1_pd(lower);
+    const __m128d hi = _mm_set1_pd(upper);
+    std::size_t k = 0;
+    for (; k + 2 <= count; k += 2) {
+        __m128d v = _mm_mul_pd(_mm_loadu_pd(in + k), s);
+        if (dither) v = _mm_add_pd(v, _mm_loadu_pd(dither + k));
+        v = _mm_min_pd(_mm_max_pd(v, lo), hi);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(out + k), _mm_cvtpd_epi32(v));
+    }
+    quantizeScalar(in + k, count - k, scale, lower, upper, dither ? dither + k : nullptr, out + k);
+}
+
+__attribute__((target("sse2")))
+DAW_NO_CONTRACT
+static void mulAddSSE2(const sample *in, std::size_t count, sample gain, sample *out) {
+    const __m128d g = _mm_set1_pd(gain);
+    std::size_t k = 0;
+    for (; k + 2 <= count; k += 2) {
+        __m128d v = _mm_mul_pd(_mm_loadu_pd(in + k), g);
+        _mm_storeu_pd(out + k, _mm_add_pd(_mm_loadu_pd(out + k), v));
+    }
+    mulAddScalar(in + k, count - k, gain, out + k);
+}
+
+// AVX2 kernels (double samples)
+
+__attribute__((target("avx2")))
+static void scaleAVX2(sample *data, std::size_t count, sample gain) {
+    const __m256d g = _mm256_set1_pd(gain);
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        _mm256_storeu_pd(data + k, _mm256_mul_pd(_mm256_loadu_pd(data + k), g));
+    }
+    scaleScalar(data + k, count - k, gain);
+}
+
+__attribute__((target("avx2")))
+static void rampAVX2(sample *data, std::size_t count, sample first, sample step, sample divisor) {
+    const __m256d d = _mm256_set1_pd(divisor);
+    const __m256d inc = _mm256_set1_pd(4.0 * step);
+    __m256d pos = _mm256_set_pd(first + 3.0 * step, first + 2.0 * step, first + step, first);
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        _mm256_storeu_pd(data + k, _mm256_mul_pd(_mm256_loadu_pd(data + k), _mm256_div_pd(pos, d)));
+        pos = _mm256_add_pd(pos, inc);
+    }
+    rampScalar(data + k, count - k, first + step * static_cast<sample>(k), step, divisor);
+}
+
+__attribute__((target("avx2")))
+static sample peakAVX2(const sample *data, std::size_t count) {
+    const __m256d absMask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    __m256d m0 = _mm256_setzero_pd();
+    __m256d m1 = _mm256_setzero_pd();
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        m0 = _mm256_max_pd(m0, _mm256_and_pd(_mm256_loadu_pd(data + k), absMask));
+        m1 = _mm256_max_pd(m1, _mm256_and_pd(_mm256_loadu_pd(data + k + 4), absMask));
+    }
+    m0 = _mm256_max_pd(m0, m1);
+    __m128d h = _mm_max_pd(_mm256_castpd256_pd128(m0), _mm256_extractf128_pd(m0, 1));
+    double lanes[2];
+    _mm_storeu_pd(lanes, h);
+    double maxAmp = lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+    double tail = peakScalar(data + k, count - k);
+    return tail > maxAmp ? tail : maxAmp;
+}
+
+__attribute__((target("avx2,fma")))
+static double sumSquaresAVX2(const sample *data, std::size_t count) {
+    __m256d s0 = _mm256_setzero_pd();
+    __m256d s1 = _mm256_setzero_pd();
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256d a = _mm256_loadu_pd(data + k);
+        __m256d b = _mm256_loadu_pd(data + k + 4);
+        s0 = _mm256_fmadd_pd(a, a, s0);
+        s1 = _mm256_fmadd_pd(b, b, s1);
+    }
+    s0 = _mm256_add_pd(s0, s1);
+    __m128d h = _mm_add_pd(_mm256_castpd256_pd128(s0), _mm256_extractf128_pd(s0, 1));
+    double lanes[2];
+    _mm_storeu_pd(lanes, h);
+    return lanes[0] + lanes[1] + sumSquaresScalar(data + k, count - k);
+}
+
+__attribute__((target("avx2")))
+static void int16ToSampleAVX2(const unsigned char *in, std::size_t count, sample *out) {
+    const __m256d scale = _mm256_set1_pd(1.0 / 32768.0);
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256i wide = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * k)));
+        _mm256_storeu_pd(out + k, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(wide)), scale));
+        _mm256_storeu_pd(out + k + 4, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(wide, 1)), scale));
+    }
+    int16ToSampleScalar(in + 2 * k, count - k, out + k);
+}
+
+__attribute__((target("avx2")))
+static void int32ToSampleAVX2(const unsigned char *in, std::size_t count, sample *out) {
+    const __m256d scale = _mm256_set1_pd(1.0 / 2147483648.0);
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 4 * k));
+        _mm256_storeu_pd(out + k, _mm256_mul_pd(_mm256_cvtepi32_pd(v), scale));
+    }
+    int32ToSampleScalar(in + 4 * k, count - k, out + k);
+}
+
+__attribute__((target("avx2")))
+DAW_NO_CONTRACT
+static void quantizeAVX2(const sample *in, std::size_t count, sample scale, sample lower, sample upper,
+                         const sample *dither, std::int32_t *out) {
+    const __m256d s = _mm256_set1_pd(scale);
+    const __m256d lo = _mm256_set1_pd(lower);
+    const __m256d hi = _mm256_set1_pd(upper);
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m256d v = _mm256_mul_pd(_mm256_loadu_pd(in + k), s);
+        if (dither) v = _mm256_add_pd(v, _mm256_loadu_pd(dither + k));
+        v = _mm256_min_pd(_mm256_max_pd(v, lo), hi);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + k), _mm256_cvtpd_epi32(v));
+    }
+    quantizeScalar(in + k, count - k, scale, lower, upper, dither ? dither + k : nullptr, out + k);
+}
+
+__attribute__((target("avx2")))
+DAW_NO_CONTRACT
+static void mulAddAVX2(const sample *in, std::size_t count, sample gain, sample *out) {
+    const __m256d g = _mm256_set1_pd(gain);
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m256d v = _mm256_mul_pd(_mm256_loadu_pd(in + k), g);
+        _mm256_storeu_pd(out + k, _mm256_add_pd(_mm256_loadu_pd(out + k), v));
+    }
+    mulAddScalar(in + k, count - k, gain, out + k);
+}
+
+// AVX-512 kernels (double samples)
+
+__attribute__((target("avx512f")))
+static void scaleAVX512(sample *data, std::size_t count, sample gain) {
+    const __m512d g = _mm512_set1_pd(gain);
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        _mm512_storeu_pd(data + k, _mm512_mul_pd(_mm512_loadu_pd(data + k), g));
+    }
+    if (k < count) {
+        __mmask8 m = static_cast<__mmask8>((1u << (count - k)) - 1u);
+        _mm512_mask_storeu_pd(data + k, m, _mm512_mul_pd(_mm512_maskz_loadu_pd(m, data + k), g));
+    }
+}
+
+__attribute__((target("avx512f")))
+static void rampAVX512(sample *data, std::size_t count, sample first, sample step, sample divisor) {
+    const __m512d d = _mm512_set1_pd(divisor);
+    const __m512d inc = _mm512_set1_pd(8.0 * step);
+    __m512d pos = _mm512_add_pd(_mm512_set1_pd(first),
+                                _mm512_mul_pd(_mm512_set_pd(7, 6, 5, 4, 3, 2, 1, 0), _mm512_set1_pd(step)));
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        _mm512_storeu_pd(data + k, _mm512_mul_pd(_mm512_loadu_pd(data + k), _mm512_div_pd(pos, d)));
+        pos = _mm512_add_pd(pos, inc);
+    }
+    if (k < count) {
+        __mmask8 m = static_cast<__mmask8>((1u << (count - k)) - 1u);
+        _mm512_mask_storeu_pd(data + k, m,
+                              _mm512_mul_pd(_mm512_maskz_loadu_pd(m, data + k), _mm512_div_pd(pos, d)));
+    }
+}
+
+// Horizontal reductions by explicit halving, in the same order on every compiler
+__attribute__((target("avx512f")))
+static double reduceMaxAVX512(__m512d v) {
+    __m256d h = _mm256_max_pd(_mm512_castpd512_pd256(v), _mm512_extractf64x4_pd(v, 1));
+    __m128d q = _mm_max_pd(_mm256_castpd256_pd128(h), _mm256_extractf128_pd(h, 1));
+    return _mm_cvtsd_f64(_mm_max_sd(q, _mm_unpackhi_pd(q, q)));
+}
+
+__attribute__((target("avx512f")))
+static double reduceAddAVX512(__m512d v) {
+    __m256d h = _mm256_add_pd(_mm512_castpd512_pd256(v), _mm512_extractf64x4_pd(v, 1));
+    __m128d q = _mm_add_pd(_mm256_castpd256_pd128(h), _mm256_extractf128_pd(h, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(q, _mm_unpackhi_pd(q, q)));
+}
+
+__attribute__((target("avx512f")))
+static sample peakAVX512(const sample *data, std::size_t count) {
+    const __m512i absMask = _mm512_set1_epi64(0x7FFFFFFFFFFFFFFFLL);
+    __m512d m0 = _mm512_setzero_pd();
+    __m512d m1 = _mm512_setzero_pd();
+    std::size_t k = 0;
+    for (; k + 16 <= count; k += 16) {
+        m0 = _mm512_max_pd(m0, _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(_mm512_loadu_pd(data + k)), absMask)));
+        m1 = _mm512_max_pd(m1, _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(_mm512_loadu_pd(data + k + 8)), absMask)));
+    }
+    double maxAmp = reduceMaxAVX512(_mm512_max_pd(m0, m1));
+    double tail = peakScalar(data + k, count - k);
+    return tail > maxAmp ? tail : maxAmp;
+}
+
+__attribute__((target("avx512f")))
+static double sumSquaresAVX512(const sample *data, std::size_t count) {
+    __m512d s0 = _mm512_setzero_pd();
+    __m512d s1 = _mm512_setzero_pd();
+    std::size_t k = 0;
+    for (; k + 16 <= count; k += 16) {
+        __m512d a = _mm512_loadu_pd(data + k);
+        __m512d b = _mm512_loadu_pd(data + k + 8);
+        s0 = _mm512_fmadd_pd(a, a, s0);
+        s1 = _mm512_fmadd_pd(b, b, s1);
+    }
+    return reduceAddAVX512(_mm512_add_pd(s0, s1)) + sumSquaresScalar(data + k, count - k);
+}
+
+__attribute__((target("avx512f")))
+static void int16ToSampleAVX512(const unsigned char *in, std::size_t count, sample *out) {
+    const __m512d scale = _mm512_set1_pd(1.0 / 32768.0);
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256i wide = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * k)));
+        _mm512_storeu_pd(out + k, _mm512_mul_pd(_mm512_cvtepi32_pd(wide), scale));
+    }
+    int16ToSampleScalar(in + 2 * k, count - k, out + k);
+}
+
+__attribute__((target("avx512f")))
+static void int32ToSampleAVX512(const unsigned char *in, std::size_t count, sample *out) {
+    const __m512d scale = _mm512_set1_pd(1.0 / 2147483648.0);
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + 4 * k));
+        _mm512_storeu_pd(out + k, _mm512_mul_pd(_mm512_cvtepi32_pd(v), scale));
+    }
+    int32ToSampleScalar(in + 4 * k, count - k, out + k);
+}
+
+__attribute__((target("avx512f")))
+DAW_NO_CONTRACT
+static void quantizeAVX512(const sample *in, std::size_t count, sample scale, sample lower, sample upper,
+                           const sample *dither, std::int32_t *out) {
+    const __m512d s = _mm512_set1_pd(scale);
+    const __m512d lo = _mm512_set1_pd(lower);
+    const __m512d hi = _mm512_set1_pd(upper);
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m512d v = _mm512_mul_pd(_mm512_loadu_pd(in + k), s);
+        if (dither) v = _mm512_add_pd(v, _mm512_loadu_pd(dither + k));
+        v = _mm512_min_pd(_mm512_max_pd(v, lo), hi);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + k), _mm512_cvtpd_epi32(v));
+    }
+    quantizeScalar(in + k, count - k, scale, lower, upper, dither ? dither + k : nullptr, out + k);
+}
+
+__attribute__((target("avx512f")))
+DAW_NO_CONTRACT
+static void mulAddAVX512(const sample *in, std::size_t count, sample gain, sample *out) {
+    const __m512d g = _mm512_set1_pd(gain);
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m512d v = _mm512_mul_pd(_mm512_loadu_pd(in + k), g);
+        _mm512_storeu_pd(out + k, _mm512_add_pd(_mm512_loadu_pd(out + k), v));
+    }
+    if (k < count) {
+        __mmask8 m = static_cast<__mmask8>((1u << (count - k)) - 1u);
+        __m512d v = _mm512_mul_pd(_mm512_maskz_loadu_pd(m, in + k), g);
+        _mm512_mask_storeu_pd(out + k, m, _mm512_add_pd(_mm512_maskz_loadu_pd(m, out + k), v));
+    }
+}
+
+#else // DAW_SAMPLE_FLOAT
+
+// SSE2 kernels (float samples)
+
+__attribute__((target("sse2")))
+static void scaleSSE2(sample *data, std::size_t count, sample gain) {
+    const __m128 g = _mm_set1_ps(gain);
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        _mm_storeu_ps(data + k, _mm_mul_ps(_mm_loadu_ps(data + k), g));
+    }
+    scaleScalar(data + k, count - k, gain);
+}
+
+__attribute__((target("sse2")))
+static void rampSSE2(sample *data, std::size_t count, sample first, sample step, sample divisor) {
+    const __m128 d = _mm_set1_ps(divisor);
+    const __m128 inc = _mm_set1_ps(4.0f * step);
+    __m128 pos = _mm_set_ps(first + 3.0f * step, first + 2.0f * step, first + step, first);
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        _mm_storeu_ps(data + k, _mm_mul_ps(_mm_loadu_ps(data + k), _mm_div_ps(pos, d)));
+        pos = _mm_add_ps(pos, inc);
+    }
+    rampScalar(data + k, count - k, first + step * static_cast<sample>(k), step, divisor);
+}
+
+__attribute__((target("sse2")))
+static sample peakSSE2(const sample *data, std::size_t count) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 m0 = _mm_setzero_ps();
+    __m128 m1 = _mm_setzero_ps();
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        m0 = _mm_max_ps(m0, _mm_and_ps(_mm_loadu_ps(data + k), absMask));
+        m1 = _mm_max_ps(m1, _mm_and_ps(_mm_loadu_ps(data + k + 4), absMask));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_max_ps(m0, m1));
+    sample maxAmp = peakScalar(lanes, 4);
+    sample tail = peakScalar(data + k, count - k);
+    return tail > maxAmp ? tail : maxAmp;
+}
+
+__attribute__((target("sse2")))
+static double sumSquaresSSE2(const sample *data, std::size_t count) {
+    double sum = 0.0;
+    std::size_t k = 0;
+    std::size_t vectorEnd = count - count % 4;
+    while (k < vectorEnd) {
+        // Accumulate short runs in float lanes, then fold them into the double total
+        std::size_t runEnd = std::min(vectorEnd, k + 1024);
+        __m128 acc = _mm_setzero_ps();
+        for (; k < runEnd; k += 4) {
+            __m128 a = _mm_loadu_ps(data + k);
+            acc = _mm_add_ps(acc, _mm_mul_ps(a, a));
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, acc);
+        sum += static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    }
+    return sum + sumSquaresScalar(data + k, count - k);
+}
+
+__attribute__((target("sse2")))
+static void int16ToSampleSSE2(const unsigned char *in, std::size_t count, sample *out) {
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * k));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(out + k, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(out + k + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    int16ToSampleScalar(in + 2 * k, count - k, out + k);
+}
+
+__attribute__((target("sse2")))
+static void int32ToSampleSSE2(const unsigned char *in, std::size_t count, sample *out) {
+    const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 4 * k));
+        _mm_storeu_ps(out + k, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+    }
+    int32ToSampleScalar(in + 4 * k, count - k, out + k);
+}
+
+__attribute__((target("sse2")))
+DAW_NO_CONTRACT
+static void quantizeSSE2(const sample *in, std::size_t count, sample scale, sample lower, sample upper,
+                         const sample *dither, std::int32_t *out) {
+    const __m128 s = _mm_set1_ps(scale);
+    const __m128 lo = _mm_set1_ps(lower);
+    const __m128 hi = _mm_set1_ps(upper);
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m128 v = _mm_mul_ps(_mm_loadu_ps(in + k), s);
+        if (dither) v = _mm_add_ps(v, _mm_loadu_ps(dither + k));
+        v = _mm_min_ps(_mm_max_ps(v, lo), hi);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + k), _mm_cvtps_epi32(v));
+    }
+    quantizeScalar(in + k, count - k, scale, lower, upper, dither ? dither + k : nullptr, out + k);
+}
+
+__attribute__((target("sse2")))
+DAW_NO_CONTRACT
+static void mulAddSSE2(const sample *in, std::size_t count, sample gain, sample *out) {
+    const __m128 g = _mm_set1_ps(gain);
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m128 v = _mm_mul_ps(_mm_loadu_ps(in + k), g);
+        _mm_storeu_ps(out + k, _mm_add_ps(_mm_loadu_ps(out + k), v));
+    }
+    mulAddScalar(in + k, count - k, gain, out + k);
+}
+
+// AVX2 kernels (float samples)
+
+__attribute__((target("avx2")))
+static void scaleAVX2(sample *data, std::size_t count, sample gain) {
+    const __m256 g = _mm256_set1_ps(gain);
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        _mm256_storeu_ps(data + k, _mm256_mul_ps(_mm256_loadu_ps(data + k), g));
+    }
+    scaleScalar(data + k, count - k, gain);
+}
+
+__attribute__((target("avx2")))
+static void rampAVX2(sample *data, std::size_t count, sample first, sample step, sample divisor) {
+    const __m256 d = _mm256_set1_ps(divisor);
+    const __m256 inc = _mm256_set1_ps(8.0f * step);
+    __m256 pos = _mm256_add_ps(_mm256_set1_ps(first),
+                               _mm256_mul_ps(_mm256_set_ps(7, 6, 5, 4, 3, 2, 1, 0), _mm256_set1_ps(step)));
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        _mm256_storeu_ps(data + k, _mm256_mul_ps(_mm256_loadu_ps(data + k), _mm256_div_ps(pos, d)));
+        pos = _mm256_add_ps(pos, inc);
+    }
+    rampScalar(data + k, count - k, first + step * static_cast<sample>(k), step, divisor);
+}
+
+__attribute__((target("avx2")))
+static sample peakAVX2(const sample *data, std::size_t count) {
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    __m256 m0 = _mm256_setzero_ps();
+    __m256 m1 = _mm256_setzero_ps();
+    std::size_t k = 0;
+    for (; k + 16 <= count; k += 16) {
+        m0 = _mm256_max_ps(m0, _mm256_and_ps(_mm256_loadu_ps(data + k), absMask));
+        m1 = _mm256_max_ps(m1, _mm256_and_ps(_mm256_loadu_ps(data + k + 8), absMask));
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, _mm256_max_ps(m0, m1));
+    sample maxAmp = peakScalar(lanes, 8);
+    sample tail = peakScalar(data + k, count - k);
+    return tail > maxAmp ? tail : maxAmp;
+}
+
+__attribute__((target("avx2,fma")))
+static double sumSquaresAVX2(const sample *data, std::size_t count) {
+    double sum = 0.0;
+    std::size_t k = 0;
+    std::size_t vectorEnd = count - count % 8;
+    while (k < vectorEnd) {
+        // Accumulate short runs in float lanes, then fold them into the double total
+        std::size_t runEnd = std::min(vectorEnd, k + 2048);
+        __m256 acc = _mm256_setzero_ps();
+        for (; k < runEnd; k += 8) {
+            __m256 a = _mm256_loadu_ps(data + k);
+            acc = _mm256_fmadd_ps(a, a, acc);
+        }
+        float lanes[8];
+        _mm256_storeu_ps(lanes, acc);
+        for (float lane : lanes) sum += lane;
+    }
+    return sum + sumSquaresScalar(data + k, count - k);
+}
+
+__attribute__((target("avx2")))
+static void int16ToSampleAVX2(const unsigned char *in, std::size_t count, sample *out) {
+    const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256i wide = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * k)));
+        _mm256_storeu_ps(out + k, _mm256_mul_ps(_mm256_cvtepi32_ps(wide), scale));
+    }
+    int16ToSampleScalar(in + 2 * k, count - k, out + k);
+}
+
+__attribute__((target("avx2")))
+static void int32ToSampleAVX2(const unsigned char *in, std::size_t count, sample *out) {
+    const __m256 scale = _mm256_set1_ps(1.0f / 2147483648.0f);
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + 4 * k));
+        _mm256_storeu_ps(out + k, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    int32ToSampleScalar(in + 4 * k, count - k, out + k);
+}
+
+__attribute__((target("avx2")))
+DAW_NO_CONTRACT
+static void quantizeAVX2(const sample *in, std::size_t count, sample scale, sample lower, sample upper,
+                         const sample *dither, std::int32_t *out) {
+    const __m256 s = _mm256_set1_ps(scale);
+    const __m256 lo = _mm256_set1_ps(lower);
+    const __m256 hi = _mm256_set1_ps(upper);
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256 v = _mm256_mul_ps(_mm256_loadu_ps(in + k), s);
+        if (dither) v = _mm256_add_ps(v, _mm256_loadu_ps(dither + k));
+        v = _mm256_min_ps(_mm256_max_ps(v, lo), hi);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + k), _mm256_cvtps_epi32(v));
+    }
+    quantizeScalar(in + k, count - k, scale, lower, upper, dither ? dither + k : nullptr, out + k);
+}
+
+__attribute__((target("avx2")))
+DAW_NO_CONTRACT
+static void mulAddAVX2(const sample *in, std::size_t count, sample gain, sample *out) {
+    const __m256 g = _mm256_set1_ps(gain);
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256 v = _mm256_mul_ps(_mm256_loadu_ps(in + k), g);
+        _mm256_storeu_ps(out + k, _mm256_add_ps(_mm256_loadu_ps(out + k), v));
+    }
+    mulAddScalar(in + k, count - k, gain, out + k);
+}
+
+// AVX-512 kernels (float samples)
+
+__attribute__((target("avx512f")))
+static void scaleAVX512(sample *data, std::size_t count, sample gain) {
+    const __m512 g = _mm512_set1_ps(gain);
+    std::size_t k = 0;
+    for (; k + 16 <= count; k += 16) {
+        _mm512_storeu_ps(data + k, _mm512_mul_ps(_mm512_loadu_ps(data + k), g));
+    }
+    if (k < count) {
+        __mmask16 m = static_cast<__mmask16>((1u << (count - k)) - 1u);
+        _mm512_mask_storeu_ps(data + k, m, _mm512_mul_ps(_mm512_maskz_loadu_ps(m, data + k), g));
+    }
+}
+
+__attribute__((target("avx512f")))
+static void rampAVX512(sample *data, std::size_t count, sample first, sample step, sample divisor) {
+    const __m512 d = _mm512_set1_ps(divisor);
+    const __m512 inc = _mm512_set1_ps(16.0f * step);
+    __m512 pos = _mm512_add_ps(_mm512_set1_ps(first),
+                               _mm512_mul_ps(_mm512_set_ps(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0),
+                                             _mm512_set1_ps(step)));
+    std::size_t k = 0;
+    for (; k + 16 <= count; k += 16) {
+        _mm512_storeu_ps(data + k, _mm512_mul_ps(_mm512_loadu_ps(data + k), _mm512_div_ps(pos, d)));
+        pos = _mm512_add_ps(pos, inc);
+    }
+    if (k < count) {
+        __mmask16 m = static_cast<__mmask16>((1u << (count - k)) - 1u);
+        _mm512_mask_storeu_ps(data + k, m,
+                              _mm512_mul_ps(_mm512_maskz_loadu_ps(m, data + k), _mm512_div_ps(pos, d)));
+    }
+}
+
+// Horizontal reductions by explicit halving, in the same order on every compiler
+__attribute__((target("avx512f")))
+static __m128 foldAVX512(__m512 v, bool maximum) {
+    __m256 low = _mm512_castps512_ps256(v);
+    __m256 high = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(v), 1));
+    __m256 h = maximum ? _mm256_max_ps(low, high) : _mm256_add_ps(low, high);
+    __m128 a = _mm256_castps256_ps128(h);
+    __m128 b = _mm256_extractf128_ps(h, 1);
+    return maximum ? _mm_max_ps(a, b) : _mm_add_ps(a, b);
+}
+
+__attribute__((target("avx512f")))
+static float reduceMaxAVX512(__m512 v) {
+    __m128 q = foldAVX512(v, true);
+    q = _mm_max_ps(q, _mm_movehl_ps(q, q));
+    return _mm_cvtss_f32(_mm_max_ss(q, _mm_shuffle_ps(q, q, 1)));
+}
+
+__attribute__((target("avx512f")))
+static float reduceAddAVX512(__m512 v) {
+    __m128 q = foldAVX512(v, false);
+    q = _mm_add_ps(q, _mm_movehl_ps(q, q));
+    return _mm_cvtss_f32(_mm_add_ss(q, _mm_shuffle_ps(q, q, 1)));
+}
+
+__attribute__((target("avx512f")))
+static sample peakAVX512(const sample *data, std::size_t count) {
+    const __m512i absMask = _mm512_set1_epi32(0x7FFFFFFF);
+    __m512 m0 = _mm512_setzero_ps();
+    __m512 m1 = _mm512_setzero_ps();
+    std::size_t k = 0;
+    for (; k + 32 <= count; k += 32) {
+        m0 = _mm512_max_ps(m0, _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(_mm512_loadu_ps(data + k)), absMask)));
+        m1 = _mm512_max_ps(m1, _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(_mm512_loadu_ps(data + k + 16)), absMask)));
+    }
+    sample maxAmp = reduceMaxAVX512(_mm512_max_ps(m0, m1));
+    sample tail = peakScalar(data + k, count - k);
+    return tail > maxAmp ? tail : maxAmp;
+}
+
+__attribute__((target("avx512f")))
+static double sumSquaresAVX512(const sample *data, std::size_t count) {
+    double sum = 0.0;
+    std::size_t k = 0;
+    std::size_t vectorEnd = count - count % 16;
+    while (k < vectorEnd) {
+        // Accumulate short runs in float lanes, then fold them into the double total
+        std::size_t runEnd = std::min(vectorEnd, k + 4096);
+        __m512 acc = _mm512_setzero_ps();
+        for (; k < runEnd; k += 16) {
+            __m512 a = _mm512_loadu_ps(data + k);
+            acc = _mm512_fmadd_ps(a, a, acc);
+        }
+        sum += reduceAddAVX512(acc);
+    }
+    return sum + sumSquaresScalar(data + k, count - k);
+}
+
+__attribute__((target("avx512f")))
+static void int16ToSampleAVX512(const unsigned char *in, std::size_t count, sample *out) {
+    const __m512 scale = _mm512_set1_ps(1.0f / 32768.0f);
+    std::size_t k = 0;
+    for (; k + 16 <= count; k += 16) {
+        __m512i wide = _mm512_cvtepi16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + 2 * k)));
+        _mm512_storeu_ps(out + k, _mm512_mul_ps(_mm512_cvtepi32_ps(wide), scale));
+    }
+    int16ToSampleScalar(in + 2 * k, count - k, out + k);
+}
+
+__attribute__((target("avx512f")))
+static void int32ToSampleAVX512(const unsigned char *in, std::size_t count, sample *out) {
+    const __m512 scale = _mm512_set1_ps(1.0f / 2147483648.0f);
+    std::size_t k = 0;
+    for (; k + 16 <= count; k += 16) {
+        __m512i v = _mm512_loadu_si512(in + 4 * k);
+        _mm512_storeu_ps(out + k, _mm512_mul_ps(_mm512_cvtepi32_ps(v), scale));
+    }
+    int32ToSampleScalar(in + 4 * k, count - k, out + k);
+}
+
+__attribute__((target("avx512f")))
+DAW_NO_CONTRACT
+static void quantizeAVX512(const sample *in, std::size_t count, sample scale, sample lower, sample upper,
+                           const sample *dither, std::int32_t *out) {
+    const __m512 s = _mm512_set1_ps(scale);
+    const __m512 lo = _mm512_set1_ps(lower);
+    const __m512 hi = _mm512_set1_ps(upper);
+    std::size_t k = 0;
+    for (; k + 16 <= count; k += 16) {
+        __m512 v = _mm512_mul_ps(_mm512_loadu_ps(in + k), s);
+        if (dither) v = _mm512_add_ps(v, _mm512_loadu_ps(dither + k));
+        v = _mm512_min_ps(_mm512_max_ps(v, lo), hi);
+        _mm512_storeu_si512(out + k, _mm512_cvtps_epi32(v));
+    }
+    quantizeScalar(in + k, count - k, scale, lower, upper, dither ? dither + k : nullptr, out + k);
+}
+
+__attribute__((target("avx512f")))
+DAW_NO_CONTRACT
+static void mulAddAVX512(const sample *in, std::size_t count, sample gain, sample *out) {
+    const __m512 g = _mm512_set1_ps(gain);
+    std::size_t k = 0;
+    for (; k + 16 <= count; k += 16) {
+        __m512 v = _mm512_mul_ps(_mm512_loadu_ps(in + k), g);
+        _mm512_storeu_ps(out + k, _mm512_add_ps(_mm512_loadu_ps(out + k), v));
+    }
+    if (k < count) {
+        __mmask16 m = static_cast<__mmask16>((1u << (count - k)) - 1u);
+        __m512 v = _mm512_mul_ps(_mm512_maskz_loadu_ps(m, in + k), g);
+        _mm512_mask_storeu_ps(out + k, m, _mm512_add_ps(_mm512_maskz_loadu_ps(m, out + k), v));
+    }
+}
+
+#endif // DAW_SAMPLE_FLOAT
+#endif // DAW_X86_KERNELS
+
+static const KernelSet scalarSet{SimdLevel::Scalar, "scalar", scaleScalar, rampScalar, peakScalar, sumSquaresScalar,
+                                 int16ToSampleScalar, int32ToSampleScalar, quantizeScalar, mulAddScalar};
+
+#ifdef DAW_X86_KERNELS
+static const KernelSet sse2Set{SimdLevel::SSE2, "sse2", scaleSSE2, rampSSE2, peakSSE2, sumSquaresSSE2,
+                               int16ToSampleSSE2, int32ToSampleSSE2, quantizeSSE2, mulAddSSE2};
+static const KernelSet avx2Set{SimdLevel::AVX2, "avx2", scaleAVX2, rampAVX2, peakAVX2, sumSquaresAVX2,
+                               int16ToSampleAVX2, int32ToSampleAVX2, quantizeAVX2, mulAddAVX2};
+static const KernelSet avx512Set{SimdLevel::AVX512, "avx512", scaleAVX512, rampAVX512, peakAVX512, sumSquaresAVX512,
+                                 int16ToSampleAVX512, int32ToSampleAVX512, quantizeAVX512, mulAddAVX512};
+#endif
+
+const KernelSet &scalarKernels() {
+    return scalarSet;
+}
+
+const KernelSet *kernelsFor(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar:
+            return &scalarSet;
+#ifdef DAW_X86_KERNELS
+        case SimdLevel::SSE2:
+            return __builtin_cpu_supports("sse2") ? &sse2Set : nullptr;
+        case SimdLevel::AVX2:
+            return (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) ? &avx2Set : nullptr;
+        case SimdLevel::AVX512:
+            return __builtin_cpu_supports("avx512f") ? &avx512Set : nullptr;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+// Picks the widest supported instruction set, capped by the DAW_SIMD environment variable
+static const KernelSet &detectKernels() {
+#ifdef DAW_X86_KERNELS
+    __builtin_cpu_init();
+#endif
+    SimdLevel cap = SimdLevel::AVX512;
+    if (const char *env = std::getenv("DAW_SIMD")) {
+        if (std::strcmp(env, "scalar") == 0) cap = SimdLevel::Scalar;
+        else if (std::strcmp(env, "sse2") == 0) cap = SimdLevel::SSE2;
+        else if (std::strcmp(env, "avx2") == 0) cap = SimdLevel::AVX2;
+    }
+    for (int level = static_cast<int>(cap); level > static_cast<int>(SimdLevel::Scalar); --level) {
+        if (const KernelSet *set = kernelsFor(static_cast<SimdLevel>(level))) {
+            return *set;
+        }
+    }
+    return scalarSet;
+}
+
+const KernelSet &activeKernels() {
+    static const KernelSet &active = detectKernels();
+    return active;
+}
+
+// Compares one kernel set with the scalar reference on a single length and start offset
+static std::size_t compareKernels(const KernelSet &set, std::size_t count, std::size_t offset, std::mt19937 &random,
+                                  std::ostream &report) {
+    const KernelSet &reference = scalarKernels();
+    std::size_t failures = 0;
+    auto fail = [&](const char *kernel) {
+        report << "  " << set.name << " " << kernel << " differs from scalar (length " << count
+               << ", offset " << offset << ")\n";
+        ++failures;
+    };
+    auto same = [](const void *a, const void *b, std::size_t bytes) { return std::memcmp(a, b, bytes) == 0; };
+
+    std::uniform_real_distribution<double> values(-1.25, 1.25);
+    std::vector<sample> input(offset + count), dither(offset + count);
+    for (std::size_t k = 0; k < input.size(); ++k) {
+        input[k] = static_cast<sample>(values(random));
+        dither[k] = static_cast<sample>(values(random) * 0.5);
+    }
+    if (count > 2) {
+        input[offset + 1] = static_cast<sample>(0.5 / 32767.0); // Rounds on a tie when quantized to 16 bits
+    }
+    const sample *in = input.data() + offset;
+    std::size_t bytes = count * sizeof(sample);
+
+    std::vector<sample> a(input), b(input);
+    reference.scale(a.data() + offset, count, sample(0.7));
+    set.scale(b.data() + offset, count, sample(0.7));
+    if (!same(a.data(), b.data(), a.size() * sizeof(sample))) fail("scale");
+
+    a = input;
+    b = input;
+    reference.ramp(a.data() + offset, count, 3, 1, 257);
+    set.ramp(b.data() + offset, count, 3, 1, 257);
+    if (!same(a.data(), b.data(), a.size() * sizeof(sample))) fail("ramp");
+
+    sample peakA = reference.peak(in, count), peakB = set.peak(in, count);
+    if (!same(&peakA, &peakB, sizeof(sample))) fail("peak");
+
+    double sumA = reference.sumSquares(in, count), sumB = set.sumSquares(in, count);
+    // Lane-wise partial sums round differently; bound the difference by the usual n * epsilon * sum
+    double tolerance = static_cast<double>(std::numeric_limits<sample>::epsilon()) * static_cast<double>(count + 1)
+                       * (sumA + 1e-30);
+    if (std::abs(sumA - sumB) > tolerance) fail("sumSquares");
+
+    std::vector<unsigned char> raw(offset + 4 * count);
+    for (unsigned char &byte : raw) {
+        byte = static_cast<unsigned char>(random());
+    }
+    a.assign(count, 0);
+    b.assign(count, 0);
+    reference.int16ToSample(raw.data() + offset, count, a.data());
+    set.int16ToSample(raw.data() + offset, count, b.data());
+    if (!same(a.data(), b.data(), bytes)) fail("int16ToSample");
+    reference.int32ToSample(raw.data() + offset, count, a.data());
+    set.int32ToSample(raw.data() + offset, count, b.data());
+    if (!same(a.data(), b.data(), bytes)) fail("int32ToSample");
+
+    std::vector<std::int32_t> quantizedA(count), quantizedB(count);
+    if (count > 0) {
+        input[offset] = std::numeric_limits<sample>::quiet_NaN(); // Must clamp to lower on every path
+    }
+    reference.quantize(in, count, 32767, -32768, 32767, nullptr, quantizedA.data());
+    set.quantize(in, count, 32767, -32768, 32767, nullptr, quantizedB.data());
+    if (quantizedA != quantizedB) fail("quantize");
+    reference.quantize(in, count, 8388607, -8388608, 8388607, dither.data() + offset, quantizedA.data());
+    set.quantize(in, count, 8388607, -8388608, 8388607, dither.data() + offset, quantizedB.data());
+    if (quantizedA != quantizedB) fail("quantize (dithered)");
+    if (count > 0) {
+        input[offset] = 0;
+    }
+
+    a.assign(dither.begin() + static_cast<std::ptrdiff_t>(offset), dither.end());
+    b = a;
+    reference.mulAdd(in, count, sample(0.3), a.data());
+    set.mulAdd(in, count, sample(0.3), b.data());
+    if (!same(a.data(), b.data(), bytes)) fail("mulAdd");
+    return failures;
+}
+
+bool checkKernels(std::ostream &report) {
+    static const std::size_t lengths[] = {0, 1, 2, 3, 5, 7, 8, 9, 15, 16, 17, 31, 33, 63, 65, 100, 257, 1023, 4099};
+    bool passed = true;
+    for (int level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(SimdLevel::AVX512); ++level) {
+        const KernelSet *set = kernelsFor(static_cast<SimdLevel>(level));
+        if (!set) {
+            continue;
+        }
+        std::mt19937 random(12345);
+        std::size_t failures = 0;
+        for (std::size_t count : lengths) {
+            for (std::size_t offset = 0; offset < 3; ++offset) {
+                failures += compareKernels(*set, count, offset, random, report);
+            }
+        }
+        report << set->name << ": " << (failures == 0 ? "ok" : "FAILED") << "\n";
+        passed = passed && failures == 0;
+    }
+    return passed;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file Kernels.hpp
+ * @brief Defines the vectorized sample-processing kernels and their runtime CPU dispatch.
+ */
+
+#ifndef DAW_KERNELS_HPP
+#define DAW_KERNELS_HPP
+
+#include "Audio.hpp" // For the sample type
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+/**
+ * @brief The instruction set a kernel set is compiled for.
+ */
+enum class SimdLevel {
+    Scalar, ///< Portable reference implementation.
+    SSE2,   ///< 128-bit SSE2 (x86 baseline).
+    AVX2,   ///< 256-bit AVX2.
+    AVX512  ///< 512-bit AVX-512F.
+};
+
+/**
+ * @brief A table of block kernels used by effects and analysis.
+ *
+ * Every instruction set provides the same functions with the same results as the
+ * scalar reference path, so callers can switch tables freely. The only exception is
+ * `sumSquares`, whose summation order (and so its last bits) depends on the lane width.
+ * All kernels operate on the build's `sample` type, float or double.
+ */
+struct KernelSet {
+    SimdLevel level;  ///< The instruction set this table was built for.
+    const char *name; ///< Human readable name of the instruction set.
+
+    /**
+     * @brief Multiplies every sample by a constant gain: `data[k] *= gain`.
+     */
+    void (*scale)(sample *data, std::size_t count, sample gain);
+
+    /**
+     * @brief Applies a linear gain ramp: `data[k] *= (first + step * k) / divisor`.
+     *
+     * `first` and `step` are expected to be whole numbers (sample positions), so the
+     * gain for each sample is bit-identical to computing it from its index directly
+     * (for float samples, as long as positions stay below 2^24).
+     */
+    void (*ramp)(sample *data, std::size_t count, sample first, sample step, sample divisor);
+
+    /**
+     * @brief Returns the largest absolute sample value in the block (0.0 for an empty block).
+     */
+    sample (*peak)(const sample *data, std::size_t count);
+
+    /**
+     * @brief Returns the sum of the squared samples in the block, used for RMS.
+     *
+     * Accumulated in double precision even for float samples, since it spans whole files.
+     */
+    double (*sumSquares)(const sample *data, std::size_t count);
+
+    /**
+     * @brief Converts little-endian signed 16-bit integers to samples: `out[k] = in[k] / 32768`.
+     *
+     * `in` is raw bytes and needs no particular alignment.
+     */
+    void (*int16ToSample)(const unsigned char *in, std::size_t count, sample *out);
+
+    /**
+     * @brief Converts little-endian signed 32-bit integers to samples: `out[k] = in[k] / 2^31`.
+     *
+     * `in` is raw bytes and needs no particular alignment.
+     */
+    void (*int32ToSample)(const unsigned char *in, std::size_t count, sample *out);
+
+    /**
+     * @brief Quantizes samples to integers: `out[k] = round(clamp(in[k] * scale + dither[k], lower, upper))`.
+     *
+     * Rounds to nearest, ties to even. `dither` may be nullptr for no dither. NaN inputs map to `lower`.
+     * The dither is added after rounding the product (no fused multiply-add), so every set matches the scalar path.
+     */
+    void (*quantize)(const sample *in, std::size_t count, sample scale, sample lower, sample upper,
+                     const sample *dither, std::int32_t *out);
+
+    /**
+     * @brief Adds a scaled block to an accumulator: `out[k] += in[k] * gain`.
+     *
+     * Multiplies and adds separately (no fused multiply-add), so every set matches the scalar path.
+     */
+    void (*mulAdd)(const sample *in, std::size_t count, sample gain, sample *out);
+};
+
+/**
+ * @brief Gets the portable scalar kernels, used as the reference implementation.
+ * @return The scalar kernel set.
+ */
+const KernelSet &scalarKernels();
+
+/**
+ * @brief Gets the kernels for a specific instruction set.
+ * @param level The requested instruction set.
+ * @return The kernel set, or nullptr if it was not compiled in or the CPU does not support it.
+ */
+const KernelSet *kernelsFor(SimdLevel level);
+
+/**
+ * @brief Gets the best kernels for the running CPU.
+ *
+ * The choice is made once, on first use, by CPU feature detection. It can be capped by
+ * setting the `DAW_SIMD` environment variable to `scalar`, `sse2`, `avx2` or `avx512`.
+ * @return The active kernel set.
+ */
+const KernelSet &activeKernels();
+
+/**
+ * @brief Checks every kernel set the CPU supports against the scalar reference path.
+ *
+ * Runs each kernel on pseudo-random data over a range of odd lengths and misaligned starts,
+ * so the vector bodies and their scalar or masked tails are both covered. Results must match
+ * bit for bit, except `sumSquares`, which only needs to agree to rounding.
+ * @param report The stream to print one line per kernel set and every mismatch to.
+ * @return True if every kernel set matches.
+ */
+bool checkKernels(std::ostream &report);
+
+#endif //DAW_KERNELS_HPP
@@ -0,0 +1,94 @@
+#include "MappedFile.hpp"
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const char *fileName) : path(fileName ? fileName : "") {
+    if (!fileName) {
+        throw std::runtime_error("File name is null.");
+    }
+    int fd = ::open(fileName, O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file for mapping: " + path + " (" + std::strerror(errno) + ")");
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::runtime_error("Failed to stat file: " + path + " (" + std::strerror(error) + ")");
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if (length > 0) {
+        void *mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            int error = errno;
+            ::close(fd);
+            throw std::runtime_error("Failed to map file: " + path + " (" + std::strerror(error) + ")");
+        }
+        address = static_cast<const unsigned char *>(mapping);
+    }
+    ::close(fd); // The mapping keeps the file referenced
+}
+
+MappedFile::~MappedFile() {
+    if (address) {
+        ::munmap(const_cast<unsigned char *>(address), length);
+    }
+}
+
+const unsigned char *MappedFile::data() const {
+    return address;
+}
+
+std::size_t MappedFile::size() const {
+    return length;
+}
+
+const std::string &MappedFile::getPath() const {
+    return path;
+}
+
+std::string canonicalPath(const std::string &fileName) {
+    char resolved[PATH_MAX];
+    return ::realpath(fileName.c_str(), resolved) ? std::string(resolved) : std::string();
+}
+
+std::string fileVersion(const std::string &fileName) {
+    struct stat info{};
+    if (::stat(fileName.c_str(), &info) != 0) {
+        return "";
+    }
+    return std::to_string(info.st_size) + ':' + std::to_string(info.st_mtim.tv_sec) + '.'
+           + std::to_string(info.st_mtim.tv_nsec);
+}
+
+MemoryStreamBuf::MemoryStreamBuf(const unsigned char *data, std::size_t size) {
+    char *begin = const_cast<char *>(reinterpret_cast<const char *>(data)); // Only ever read through the get area
+    setg(begin, begin, begin + size);
+}
+
+MemoryStreamBuf::pos_type MemoryStreamBuf::seekoff(off_type offset, std::ios_base::seekdir dir,
+                                                   std::ios_base::openmode which) {
+    if (!(which & std::ios_base::in)) {
+        return pos_type(off_type(-1));
+    }
+    off_type base = (dir == std::ios_base::beg) ? 0
+                    : (dir == std::ios_base::cur) ? gptr() - eback()
+                    : egptr() - eback();
+    off_type target = base + offset;
+    if (target < 0 || target > egptr() - eback()) {
+        return pos_type(off_type(-1));
+    }
+    setg(eback(), eback() + target, egptr());
+    return pos_type(target);
+}
+
+MemoryStreamBuf::pos_type MemoryStreamBuf::seekpos(pos_type position, std::ios_base::openmode which) {
+    return seekoff(off_type(position), std::ios_base::beg, which);
+}
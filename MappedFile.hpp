@@ -0,0 +1,95 @@
+/**
+ * @file MappedFile.hpp
+ * @brief Defines the MappedFile class, a read-only memory mapping of a whole file.
+ */
+
+#ifndef DAW_MAPPEDFILE_HPP
+#define DAW_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <streambuf>
+#include <string>
+
+/**
+ * @brief A read-only memory mapping of a file, unmapped on destruction.
+ *
+ * Pages are loaded by the operating system when first touched, so mapping a large
+ * file is O(1) and only the parts that are actually read become resident.
+ */
+class MappedFile {
+private:
+    const unsigned char *address = nullptr; ///< Start of the mapping, or nullptr for an empty file.
+    std::size_t length = 0;                 ///< Size of the mapping in bytes.
+    std::string path;                       ///< The mapped file's path.
+
+public:
+    /**
+     * @brief Maps a file into memory.
+     * @param fileName The path of the file to map.
+     * @throws std::runtime_error if the file cannot be opened or mapped.
+     */
+    explicit MappedFile(const char *fileName);
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /**
+     * @brief Unmaps the file.
+     */
+    ~MappedFile();
+
+    /**
+     * @brief Gets the mapped bytes.
+     * @return A pointer to the first byte of the file.
+     */
+    const unsigned char *data() const;
+
+    /**
+     * @brief Gets the size of the file.
+     * @return The size in bytes.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Gets the path of the mapped file.
+     * @return The path, as given to the constructor.
+     */
+    const std::string &getPath() const;
+};
+
+/**
+ * @brief Resolves a path to an absolute one with no symbolic links, `.` or `..` components.
+ * @param fileName The path of an existing file.
+ * @return The canonical path, or an empty string if the file cannot be resolved.
+ */
+std::string canonicalPath(const std::string &fileName);
+
+/**
+ * @brief Describes the current state of a file, to tell whether it changed since an earlier call.
+ * @param fileName The path of the file.
+ * @return The file's size and modification time as text, or an empty string if it cannot be read.
+ */
+std::string fileVersion(const std::string &fileName);
+
+/**
+ * @brief A read-only, seekable stream buffer over a block of memory.
+ *
+ * Lets stream-based parsers such as `readWavHeader` run directly on a mapping.
+ */
+class MemoryStreamBuf : public std::streambuf {
+public:
+    /**
+     * @brief Constructs a stream buffer over `[data, data + size)`.
+     * @param data The first byte.
+     * @param size The number of bytes.
+     */
+    MemoryStreamBuf(const unsigned char *data, std::size_t size);
+
+protected:
+    pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+
+    pos_type seekpos(pos_type position, std::ios_base::openmode which) override;
+};
+
+#endif //DAW_MAPPEDFILE_HPP
@@ -0,0 +1,109 @@
+#include "MappedWavAudio.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+MappedWavAudio::Mapping::Mapping(const char *fileName) : file(fileName) {
+    MemoryStreamBuf buffer(file.data(), file.size());
+    std::istream header(&buffer);
+    format = readWavHeader(header); // Clamps the data size to the mapped length
+    frames = file.data() + format.dataOffset;
+}
+
+MappedWavAudio::MappedWavAudio(const char *fileName) : Audio() {
+    try {
+        mapping = std::make_shared<Mapping>(fileName);
+    } catch (const std::exception &ex) {
+        std::cerr << "Error mapping WAV file: " << ex.what() << std::endl;
+        throw;
+    }
+    const WavFormat &format = mapping->format;
+    this->setSampleRate(static_cast<float>(format.sampleRate));
+    this->setSampleSize(format.frameCount());
+    this->setDuration(static_cast<double>(this->getSampleSize()) / this->getSampleRate());
+    this->setChannels(format.channels);
+}
+
+sample MappedWavAudio::operator[](std::size_t index) const {
+    if (index >= this->getSampleSize()) {
+        return 0;
+    }
+    sample value;
+    // The first sample of a frame belongs to the first channel
+    convertWavSamples(mapping->format, mapping->frames + index * mapping->format.blockAlign, 1, &value);
+    return value;
+}
+
+sample &MappedWavAudio::operator[](std::size_t /*index*/) {
+    throw std::logic_error("MappedWavAudio does not support sample modification.");
+}
+
+void MappedWavAudio::render(std::size_t start, std::size_t count, sample *const *out) const {
+    std::size_t size = this->getSampleSize();
+    std::size_t available = (start < size) ? std::min(count, size - start) : 0;
+    if (available > 0) {
+        decodeWavFrames(mapping->format, mapping->frames + start * mapping->format.blockAlign, available, out);
+    }
+    for (unsigned c = 0; c < this->getChannels(); ++c) {
+        std::fill(out[c] + available, out[c] + count, 0.0);
+    }
+}
+
+AudioStats MappedWavAudio::analyze() const {
+    std::shared_ptr<const AudioStats> cached = std::atomic_load(&mapping->stats);
+    if (!cached) {
+        cached = std::make_shared<const AudioStats>(Audio::analyze());
+        std::atomic_store(&mapping->stats, cached);
+    }
+    return *cached;
+}
+
+bool MappedWavAudio::getSource(AudioSource &source) const {
+    source.path = canonicalPath(mapping->file.getPath());
+    if (source.path.empty()) {
+        return false; // Removed since it was mapped
+    }
+    source.command = "MMAP " + source.path;
+    return true;
+}
+
+MappedWavAudio *MappedWavAudio::clone() const {
+    return new MappedWavAudio(*this);
+}
+
+std::ostream &MappedWavAudio::printToStream(std::ostream &out) const {
+    out << "MappedWavAudio: " << mapping->file.getPath() << ", " << this->getSampleSize() << " samples x "
+        << this->getChannels() << " channels @ " << this->getSampleRate() << "Hz\n";
+    return out;
+}
+
+MappedWavAudioCreator::MappedWavAudioCreator() : AudioCreator("MMAP") {
+
+}
+
+bool MappedWavAudioCreator::readParameters(std::istream &in, std::string &parameters) const {
+    in >> parameters;
+    return true;
+}
+
+std::string MappedWavAudioCreator::getVersion(const std::string &parameters) const {
+    return fileVersion(parameters);
+}
+
+Audio *MappedWavAudioCreator::createAudio(std::istream &in) const {
+    try {
+
+        std::string fileName;
+        in >> fileName;
+
+        return new MappedWavAudio(fileName.c_str());
+
+    } catch (const std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        throw;
+    } catch (...) {
+        throw;
+    }
+}
+
+static MappedWavAudioCreator __;
@@ -0,0 +1,137 @@
+/**
+ * @file MappedWavAudio.hpp
+ * @brief Defines the MappedWavAudio class, a WAV file decoded on demand from a memory mapping, and its creator.
+ */
+
+#ifndef DAW_MAPPEDWAVAUDIO_HPP
+#define DAW_MAPPEDWAVAUDIO_HPP
+
+#include "Audio.hpp"
+#include "MappedFile.hpp"
+#include "WavFormat.hpp"
+#include <memory>
+
+/**
+ * @brief Audio read from a memory-mapped WAV file, decoded only when rendered.
+ *
+ * Opening parses the header once and maps the file; no samples are decoded up front,
+ * so opening is O(1) in the file length and only the pages a session actually
+ * renders become resident. Clones share the mapping and the cached statistics.
+ * The audio is read-only.
+ */
+class MappedWavAudio : public Audio {
+private:
+    /**
+     * @brief State shared by every clone of one opened file.
+     */
+    struct Mapping {
+        MappedFile file;                          ///< The mapped file.
+        WavFormat format;                         ///< The parsed header.
+        const unsigned char *frames = nullptr;    ///< The first frame of the data chunk inside the mapping.
+        std::shared_ptr<const AudioStats> stats;  ///< Cached statistics, if computed.
+
+        /**
+         * @brief Maps the file and parses its header.
+         * @param fileName The path of the WAV file.
+         */
+        explicit Mapping(const char *fileName);
+    };
+
+    std::shared_ptr<Mapping> mapping; ///< The shared mapping.
+
+public:
+    /**
+     * @brief Maps a WAV file and reads its header.
+     * @param fileName The path of the WAV file.
+     * @throws std::runtime_error if the file cannot be mapped or is not a supported WAV file.
+     */
+    explicit MappedWavAudio(const char *fileName);
+
+    /**
+     * @brief Decodes a sample of the first channel straight from the mapping.
+     * @param index The index of the sample.
+     * @return The sample value, or 0.0 past the end.
+     */
+    sample operator[](std::size_t index) const override;
+
+    /**
+     * @brief Accesses a sample (non-const version).
+     * @throws std::logic_error as mapped audio is read-only.
+     * @param index The sample index (unused).
+     * @return A reference to a sample (never actually returns due to exception).
+     */
+    sample &operator[](std::size_t index) override;
+
+    /**
+     * @brief Decodes a block of every channel straight from the mapping into the planes.
+     * @param start The index of the first sample to render.
+     * @param count The number of samples to render per channel.
+     * @param out One destination plane per channel; samples past the end are written as silence.
+     */
+    void render(std::size_t start, std::size_t count, sample *const *out) const override;
+
+    /**
+     * @brief Gets the peak and RMS level of the file.
+     *
+     * Computed once with the default parallel scan and cached, shared with every clone.
+     * @return The level statistics of the audio.
+     */
+    AudioStats analyze() const override;
+
+    /**
+     * @brief Gets the command that reopens the mapped file.
+     * @param source Receives "MMAP <path>" and the path.
+     * @return Always true.
+     */
+    bool getSource(AudioSource &source) const override;
+
+    /**
+     * @brief Clones the MappedWavAudio object.
+     * @return A pointer to a new MappedWavAudio sharing the same mapping.
+     */
+    MappedWavAudio *clone() const override;
+
+    /**
+     * @brief Prints a summary of the mapped file to an output stream.
+     * @param out The output stream.
+     * @return A reference to the output stream.
+     */
+    std::ostream &printToStream(std::ostream &out) const override;
+};
+
+/**
+ * @brief Creator class for MappedWavAudio objects.
+ *
+ * Responds to the "MMAP" command followed by a WAV file name.
+ */
+class MappedWavAudioCreator : public AudioCreator {
+public:
+    /**
+     * @brief Constructs a MappedWavAudioCreator and registers it under "MMAP".
+     */
+    MappedWavAudioCreator();
+
+    /**
+     * @brief Reads the file name, so a live node for the file is found before it is mapped.
+     * @param in The input stream, positioned at the file name.
+     * @param parameters Receives the file name.
+     * @return True.
+     */
+    bool readParameters(std::istream &in, std::string &parameters) const override;
+
+    /**
+     * @brief Gets the version of the file, so a node made before the file changed is not reused.
+     * @param parameters The file name.
+     * @return The value of `fileVersion()` for the file.
+     */
+    std::string getVersion(const std::string &parameters) const override;
+
+    /**
+     * @brief Creates a MappedWavAudio object from an input stream.
+     * @param in The input stream, positioned at the file name.
+     * @return A pointer to the created MappedWavAudio object.
+     */
+    Audio *createAudio(std::istream &in) const override;
+};
+
+#endif //DAW_MAPPEDWAVAUDIO_HPP
@@ -1 +1,194 @@
 #include "Project.hpp"
+#include "ProjectFile.hpp"
+#include "Kernels.hpp"
+#include "SampleBuffer.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <stdexcept>
+#include <string>
+
+/// The most blocks a track renders per span; bounds the scratch memory for projects with few tracks
+static constexpr std::size_t maxBlocksPerSpan = 16;
+
+Project::Project(double frequency, int trackAmount)
+        : sampleRate(static_cast<float>(frequency)), saveCache(std::make_shared<ProjectSaveCache>()) {
+    if (!Audio::isValidSampleRate(this->sampleRate)) {
+        throw std::invalid_argument("Invalid project sample rate: " + std::to_string(frequency));
+    }
+    if (trackAmount < 0) {
+        throw std::invalid_argument("Invalid project track amount: " + std::to_string(trackAmount));
+    }
+    this->tracks.assign(static_cast<std::size_t>(trackAmount), Track(this->sampleRate));
+}
+
+std::size_t Project::getTrackCount() const {
+    return this->tracks.size();
+}
+
+Track &Project::getTrack(std::size_t index) {
+    if (index >= this->tracks.size()) {
+        throw std::out_of_range("Track index " + std::to_string(index) + " is out of range");
+    }
+    return this->tracks[index];
+}
+
+const Track &Project::getTrack(std::size_t index) const {
+    if (index >= this->tracks.size()) {
+        throw std::out_of_range("Track index " + std::to_string(index) + " is out of range");
+    }
+    return this->tracks[index];
+}
+
+float Project::getSampleRate() const {
+    return this->sampleRate;
+}
+
+std::size_t Project::getSampleSize() const {
+    std::size_t size = 0;
+    for (const Track &track : this->tracks) {
+        size = std::max(size, track.getSampleSize());
+    }
+    return size;
+}
+
+unsigned Project::getChannels() const {
+    unsigned channels = 1;
+    for (const Track &track : this->tracks) {
+        channels = std::max(channels, track.getChannels());
+    }
+    return channels;
+}
+
+std::size_t Project::blocksPerSpan() const {
+    if (this->tracks.empty()) {
+        return 1;
+    }
+    for (const Track &track : this->tracks) {
+        if (!track.isRandomAccess()) {
+            return 1; // Its blocks must be rendered one after another
+        }
+    }
+    // Two tasks per thread, counting the caller, leaves room to balance uneven tracks
+    std::size_t threads = ThreadPool::getInstance().getThreadCount() + 1;
+    std::size_t wanted = (2 * threads + this->tracks.size() - 1) / this->tracks.size();
+    return std::min(std::max<std::size_t>(wanted, 1), maxBlocksPerSpan);
+}
+
+void Project::mixSpan(std::size_t start, std::size_t count, sample *const *out, const PlanarBlock &scratch,
+                      std::size_t blocks) const {
+    unsigned channels = this->getChannels();
+    for (unsigned c = 0; c < channels; ++c) {
+        std::fill(out[c], out[c] + count, 0.0);
+    }
+    std::size_t used = (count + Audio::blockSize - 1) / Audio::blockSize;
+    std::size_t tasks = this->tracks.size() * used;
+    std::vector<char> silent(tasks, 0);
+
+    auto planesOf = [&](std::size_t track, std::size_t block) {
+        return scratch.planes() + (track * blocks + block) * channels;
+    };
+    ThreadPool::getInstance().parallelFor(0, tasks, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t task = begin; task < end; ++task) {
+            std::size_t track = task / used;
+            std::size_t block = task % used;
+            std::size_t offset = block * Audio::blockSize;
+            std::size_t n = std::min(Audio::blockSize, count - offset);
+            if (this->tracks[track].describeRegion(start + offset, n).isSilent()) {
+                silent[task] = 1;
+                continue;
+            }
+            this->tracks[track].render(start + offset, n, planesOf(track, block));
+        }
+    });
+
+    // Reduce in track order so every block sums identically on every run
+    const KernelSet &kernels = activeKernels();
+    for (std::size_t block = 0; block < used; ++block) {
+        std::size_t offset = block * Audio::blockSize;
+        std::size_t n = std::min(Audio::blockSize, count - offset);
+        for (std::size_t track = 0; track < this->tracks.size(); ++track) {
+            if (silent[track * used + block]) {
+                continue;
+            }
+            sample *const *planes = planesOf(track, block);
+            unsigned trackChannels = this->tracks[track].getChannels();
+            unsigned fed = trackChannels == 1 ? channels : trackChannels;
+            for (unsigned c = 0; c < fed; ++c) {
+                kernels.mulAdd(planes[trackChannels == 1 ? 0 : c], n, 1, out[c] + offset);
+            }
+        }
+    }
+}
+
+void Project::render(std::size_t start, std::size_t count, sample *const *out) const {
+    unsigned channels = this->getChannels();
+    std::size_t blocks = this->blocksPerSpan();
+    std::size_t span = blocks * Audio::blockSize;
+    PlanarBlock scratch(static_cast<unsigned>(this->tracks.size() * blocks * channels));
+    std::vector<sample *> planes(channels);
+    for (std::size_t pos = 0; pos < count; pos += span) {
+        for (unsigned c = 0; c < channels; ++c) {
+            planes[c] = out[c] + pos;
+        }
+        this->mixSpan(start + pos, std::min(span, count - pos), planes.data(), scratch, blocks);
+    }
+}
+
+std::uint64_t Project::mixdown(std::ostream &out, WavEncoding encoding, unsigned bitsPerSample,
+                               WavDither dither) const {
+    unsigned channels = this->getChannels();
+    std::size_t size = this->getSampleSize();
+    std::size_t blocks = this->blocksPerSpan();
+    std::size_t span = blocks * Audio::blockSize;
+    WavWriter writer(out, channels, static_cast<unsigned>(std::lround(this->sampleRate)), encoding, bitsPerSample,
+                     dither, size);
+    PlanarBlock scratch(static_cast<unsigned>(this->tracks.size() * blocks * channels));
+    PlanarBlock master(channels, span);
+    for (std::size_t pos = 0; pos < size; pos += span) {
+        std::size_t count = std::min(span, size - pos);
+        this->mixSpan(pos, count, master.planes(), scratch, blocks);
+        writer.write(master.planes(), count);
+    }
+    writer.finish();
+    return writer.getFramesWritten();
+}
+
+Project Project::createNew(const char *name) {
+    Project project(44100.0, 1);
+    project.save(name);
+    return project;
+}
+
+void Project::save(const char *projectName) const {
+    try {
+        saveProjectFile(*this, projectName, *this->saveCache);
+    } catch (const std::exception &ex) {
+        std::cerr << "Error saving project: " << ex.what() << std::endl;
+        throw;
+    }
+}
+
+std::future<void> Project::saveAsync(const char *projectName) const {
+    Project snapshot(*this);
+    std::string name = projectName;
+    return std::async(std::launch::async, [snapshot, name]() { snapshot.save(name.c_str()); });
+}
+
+void Project::load(const char *projectName) {
+    auto cache = std::make_shared<ProjectSaveCache>();
+    try {
+        Project loaded = loadProjectFile(projectName, *cache);
+        loaded.saveCache = cache;
+        *this = std::move(loaded);
+    } catch (const std::exception &ex) {
+        std::cerr << "Error loading project: " << ex.what() << std::endl;
+        throw;
+    }
+}
+
+Track &Project::addTrack() {
+    this->tracks.emplace_back(this->sampleRate);
+    return this->tracks.back();
+}
@@ -7,6 +7,14 @@
 #define DAW_PROJECT_HPP
 
 #include "Track.hpp" // Assumes Track.hpp defines the Track class
+#include "WavWriter.hpp"
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <ostream>
+
+class PlanarBlock;
+class ProjectSaveCache;
 
 /**
  * @brief Represents an audio project, which consists of multiple tracks.
@@ -17,6 +25,32 @@
 class Project {
 private:
     std::vector<Track> tracks; ///< A collection of tracks within the project.
+    float sampleRate;          ///< The master sample rate of the project in Hz.
+    std::shared_ptr<ProjectSaveCache> saveCache; ///< What earlier saves wrote, shared with snapshots.
+
+    /**
+     * @brief Mixes a span of the master bus using caller-provided track buffers.
+     *
+     * Every (track, block) pair is rendered as an independent pool task into its own buffer.
+     * The buffers are then summed into the master bus block by block in track order, so the
+     * result is bit-identical whatever the number of threads or the order tasks ran in.
+     * @param start The index of the first sample to mix.
+     * @param count The number of samples to mix; at most `blocks * Audio::blockSize`.
+     * @param out One destination plane per master channel.
+     * @param scratch Planes for every track and block: `tracks * blocks * channels` of `Audio::blockSize`.
+     * @param blocks The number of blocks the scratch has room for per track.
+     */
+    void mixSpan(std::size_t start, std::size_t count, sample *const *out, const PlanarBlock &scratch,
+                 std::size_t blocks) const;
+
+    /**
+     * @brief Picks how many blocks each track renders per span.
+     *
+     * Enough (track, block) tasks are made to keep every worker busy even with few tracks.
+     * Tracks that must be rendered in order get a single block per span.
+     * @return The number of blocks per track per span.
+     */
+    std::size_t blocksPerSpan() const;
 
 public:
     /**
@@ -28,32 +62,115 @@ public:
      */
     Project(double frequency, int trackAmount);
 
+    /**
+     * @brief Gets the number of tracks.
+     * @return The number of tracks.
+     */
+    std::size_t getTrackCount() const;
+
+    /**
+     * @brief Gets a track for editing.
+     * @param index The track index.
+     * @return The track.
+     * @throws std::out_of_range if the index is invalid.
+     */
+    Track &getTrack(std::size_t index);
+
+    /**
+     * @brief Gets a track.
+     * @param index The track index.
+     * @return The track.
+     * @throws std::out_of_range if the index is invalid.
+     */
+    const Track &getTrack(std::size_t index) const;
+
+    /**
+     * @brief Gets the master sample rate.
+     * @return The sample rate in Hz.
+     */
+    float getSampleRate() const;
+
+    /**
+     * @brief Gets the length of the master bus: the end of the longest track.
+     * @return The number of samples per channel.
+     */
+    std::size_t getSampleSize() const;
+
+    /**
+     * @brief Gets the channel count of the master bus: that of the widest track.
+     * @return The number of channels, at least 1.
+     */
+    unsigned getChannels() const;
+
+    /**
+     * @brief Renders the master bus: the sum of all tracks.
+     *
+     * Tracks are rendered in parallel on the thread pool and summed in track order.
+     * Mono tracks feed every master channel; other tracks feed the channels they have.
+     * @param start The index of the first sample to render.
+     * @param count The number of samples to render per channel.
+     * @param out One destination plane per master channel.
+     */
+    void render(std::size_t start, std::size_t count, sample *const *out) const;
+
+    /**
+     * @brief Renders the whole master bus into a WAV stream and finishes the file.
+     * @param out The destination stream, opened in binary mode.
+     * @param encoding PCM or float output.
+     * @param bitsPerSample 16, 24 or 32 for PCM; 32 for float.
+     * @param dither The rounding mode for PCM output.
+     * @return The number of frames written.
+     */
+    std::uint64_t mixdown(std::ostream &out, WavEncoding encoding = WavEncoding::PCM, unsigned bitsPerSample = 16,
+                          WavDither dither = WavDither::None) const;
+
     /**
      * @brief Creates a new project with a given name.
      *
-     * This static factory method might handle setting up a default project structure
-     * or preparing storage associated with the project name.
-     * @param name The name for the new project. This could be a file path or an identifier.
-     * @return A Project object initialized for a new project.
-     * @note The implementation details (e.g., if it creates files on disk immediately) are not defined here.
+     * The project has one empty track at 44100 Hz and is saved to `name` straight away.
+     * @param name The path of the project file to create.
+     * @return The new project.
+     * @throws std::runtime_error if the file cannot be written.
      */
     static Project createNew(const char* name);
 
     /**
-     * @brief Saves the current state of the project.
-     * @param projectName The name (often a file path) to which the project should be saved.
-     *                    This method would serialize all tracks and project-specific data.
+     * @brief Saves the current state of the project in the binary project format.
+     *
+     * Saving over an earlier save of the same project only appends the tracks and sources that
+     * changed; see `saveProjectFile()`.
+     * @param projectName The path of the project file.
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void save(const char* projectName) const;
+
+    /**
+     * @brief Saves a snapshot of the project on a background thread.
+     *
+     * Taking the snapshot copies the clip lists only; the sources are shared. The project can be
+     * edited, and saved again, while the save runs: saves of one project run one at a time.
+     * The caller must keep the returned future for as long as the save should run in the
+     * background: destroying it waits for the save to finish, so a discarded future makes
+     * the call as slow as `save()`.
+     * @param projectName The path of the project file.
+     * @return A future that completes when the save has finished, rethrowing its errors.
+     */
+    [[nodiscard]] std::future<void> saveAsync(const char* projectName) const;
+
+    /**
+     * @brief Replaces this project with one loaded from a project file.
+     *
+     * Embedded sources are read from a mapping of the file, not copied.
+     * @param projectName The path of the project file.
+     * @throws std::runtime_error if the file is not a valid project.
      */
-    void save(const char* projectName);
+    void load(const char* projectName);
 
     /**
-     * @brief Loads a project from a specified location.
-     * @param projectName The name (often a file path) from which to load the project.
-     *                    This method would deserialize project data and reconstruct the tracks.
-     * @note The parameter type `const char& projectName` seems unusual for a C-style string (filename)
-     *       and is likely intended to be `const char* projectName`. This should be reviewed.
+     * @brief Appends an empty track at the project sample rate.
+     * @return The new track.
      */
-    void load(const char& projectName); // TODO: Review parameter type, likely should be const char*
+    Track &addTrack();
 };
 
 #endif //DAW_PROJECT_HPP
@@ -0,0 +1,411 @@
+#include "ProjectFile.hpp"
+#include "AudioFactory.hpp"
+#include "ClipAudio.hpp"
+#include "Hash.hpp"
+#include "MappedFile.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+/// The magic bytes at the start of every project file
+static constexpr char projectMagic[8] = {'D', 'A', 'W', 'P', 'R', 'O', 'J', '\0'};
+
+/// The project format version written and accepted
+static constexpr std::uint32_t projectVersion = 1;
+
+/// The alignment of every section, so embedded clip planes can be used in place
+static constexpr std::uint64_t sectionAlignment = ClipAudio::planeAlignment;
+
+/// Dead bytes always tolerated before a save rewrites the whole file
+static constexpr std::uint64_t compactionSlack = 1 << 20;
+
+static std::uint64_t alignSection(std::uint64_t offset) {
+    return (offset + sectionAlignment - 1) / sectionAlignment * sectionAlignment;
+}
+
+// Gets the size of a file, or false if it does not exist
+static bool fileSize(const char *fileName, std::uint64_t &size) {
+    struct stat info{};
+    if (::stat(fileName, &info) != 0) {
+        return false;
+    }
+    size = static_cast<std::uint64_t>(info.st_size);
+    return true;
+}
+
+bool ProjectSaveCache::find(const std::shared_ptr<const Audio> &audio, std::uint64_t &id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = embedded.find(audio.get());
+    if (found == embedded.end()) {
+        return false;
+    }
+    if (found->second.audio.lock() != audio) {
+        embedded.erase(found); // A different source now lives at the same address
+        return false;
+    }
+    id = found->second.id;
+    return true;
+}
+
+void ProjectSaveCache::remember(const std::shared_ptr<const Audio> &audio, std::uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    embedded[audio.get()] = Entry{audio, id};
+}
+
+/**
+ * @brief A mapped project file with its validated header and section table.
+ */
+struct ProjectImage {
+    std::shared_ptr<const MappedFile> file;  ///< The mapping.
+    ProjectFileHeader header{};              ///< The header.
+    std::vector<ProjectSectionEntry> table;  ///< The section table.
+};
+
+// Maps and validates a project file
+static ProjectImage readImage(const char *fileName) {
+    ProjectImage image;
+    image.file = std::make_shared<const MappedFile>(fileName);
+    const std::string &path = image.file->getPath();
+    std::uint64_t size = image.file->size();
+    if (size < sizeof(ProjectFileHeader)) {
+        throw std::runtime_error("Invalid project file: too short for a header: " + path);
+    }
+    std::memcpy(&image.header, image.file->data(), sizeof(image.header));
+    if (std::memcmp(image.header.magic, projectMagic, sizeof(projectMagic)) != 0) {
+        throw std::runtime_error("Invalid project file: bad magic: " + path);
+    }
+    if (image.header.version != projectVersion) {
+        throw std::runtime_error("Unsupported project version " + std::to_string(image.header.version) + ": " + path);
+    }
+    const ProjectFileHeader &header = image.header;
+    if (header.tableOffset > size || header.tableEntries > (size - header.tableOffset) / sizeof(ProjectSectionEntry)
+        || header.trackCount > header.tableEntries) {
+        throw std::runtime_error("Invalid project file: truncated section table: " + path);
+    }
+    image.table.resize(header.tableEntries);
+    std::memcpy(image.table.data(), image.file->data() + header.tableOffset,
+                image.table.size() * sizeof(ProjectSectionEntry));
+    for (const ProjectSectionEntry &entry : image.table) {
+        if (entry.offset % sectionAlignment != 0 || entry.offset > size || entry.size > size - entry.offset) {
+            throw std::runtime_error("Invalid project file: section out of bounds: " + path);
+        }
+    }
+    return image;
+}
+
+/**
+ * @brief Writes the sections of one save, reusing those an existing file already holds.
+ */
+class ProjectWriter {
+private:
+    std::fstream &out;                                                  ///< The project file.
+    ProjectSaveCache &cache;                                            ///< The project's save cache.
+    std::uint64_t end;                                                  ///< Where the next section goes.
+    std::unordered_map<std::uint64_t, ProjectSectionEntry> available;   ///< Sections of the existing file.
+    std::unordered_map<std::uint64_t, ProjectSectionEntry> placed;      ///< Sections used by this save.
+    std::unordered_map<const Audio *, std::uint64_t> sourceIds;         ///< Source ids resolved by this save.
+
+    // Finds a section this save can use without writing it
+    bool reuse(ProjectSectionKind kind, std::uint64_t id) {
+        if (this->placed.count(id)) {
+            return true;
+        }
+        auto found = this->available.find(id);
+        if (found == this->available.end() || found->second.kind != static_cast<std::uint32_t>(kind)) {
+            return false;
+        }
+        this->placed[id] = found->second;
+        this->used.push_back(found->second);
+        return true;
+    }
+
+    // Records a section written at `end`
+    void commit(ProjectSectionKind kind, std::uint64_t id, std::uint64_t size) {
+        ProjectSectionEntry entry{static_cast<std::uint32_t>(kind), 0, id, this->end, size};
+        this->placed[id] = entry;
+        this->used.push_back(entry);
+        this->appended += size;
+        this->end = alignSection(this->end + size);
+    }
+
+public:
+    std::vector<ProjectSectionEntry> used; ///< Every distinct section of this save, in first-use order.
+    std::uint64_t appended = 0;            ///< Bytes of new sections written by this save.
+
+    /**
+     * @brief Prepares a save.
+     * @param out The project file, open for writing.
+     * @param cache The project's save cache.
+     * @param end The first free aligned offset.
+     * @param existing The sections of the existing file.
+     */
+    ProjectWriter(std::fstream &out, ProjectSaveCache &cache, std::uint64_t end,
+                  const std::vector<ProjectSectionEntry> &existing) : out(out), cache(cache), end(end) {
+        for (const ProjectSectionEntry &entry : existing) {
+            this->available.emplace(entry.id, entry);
+        }
+    }
+
+    /**
+     * @brief Places a section, writing it only if no equal section exists yet.
+     * @param kind The kind of the section.
+     * @param payload The section bytes.
+     * @return The table entry of the section.
+     */
+    ProjectSectionEntry place(ProjectSectionKind kind, const std::string &payload) {
+        std::uint64_t id = hashBytes(payload.data(), payload.size());
+        if (!this->reuse(kind, id)) {
+            this->out.seekp(static_cast<std::streamoff>(this->end));
+            this->out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+            this->commit(kind, id, payload.size());
+        }
+        return this->placed[id];
+    }
+
+    /**
+     * @brief Places the section of a clip source.
+     *
+     * Sources with a factory command are stored as a reference with the hash of their file.
+     * Other sources are rendered into an embedded clip image, unless the cache knows them.
+     * @param audio The source.
+     * @return The id of its section.
+     */
+    std::uint64_t placeSource(const std::shared_ptr<const Audio> &audio) {
+        auto known = this->sourceIds.find(audio.get());
+        if (known != this->sourceIds.end()) {
+            return known->second;
+        }
+        std::uint64_t id;
+        AudioSource source;
+        if (audio->getSource(source)) {
+            ProjectReferenceRecord record{static_cast<std::uint32_t>(source.command.size()),
+                                          static_cast<std::uint32_t>(source.path.size()), 0, 0};
+            if (!source.path.empty()) {
+                if (!fileSize(source.path.c_str(), record.fileSize)) {
+                    throw std::runtime_error("Referenced file is missing: " + source.path);
+                }
+                record.fileHash = hashFile(source.path.c_str());
+            }
+            std::string payload(reinterpret_cast<const char *>(&record), sizeof(record));
+            payload += source.command;
+            payload += source.path;
+            id = this->place(ProjectSectionKind::SourceReference, payload).id;
+        } else if (!this->cache.find(audio, id) || !this->reuse(ProjectSectionKind::SourceEmbedded, id)) {
+            this->out.seekp(static_cast<std::streamoff>(this->end));
+            ClipHeader header = writeClip(*audio, this->out, sizeof(sample), &id);
+            if (!this->reuse(ProjectSectionKind::SourceEmbedded, id)) {
+                this->commit(ProjectSectionKind::SourceEmbedded, id, clipImageSize(header));
+            } // Otherwise an equal image exists and the next section overwrites this one
+            this->cache.remember(audio, id);
+        }
+        this->sourceIds[audio.get()] = id;
+        return id;
+    }
+
+    /**
+     * @brief Gets the offset after the last section.
+     * @return The first free aligned offset.
+     */
+    std::uint64_t getEnd() const {
+        return this->end;
+    }
+};
+
+// Writes the table and then the header that makes it current
+static void finishImage(std::fstream &out, std::uint64_t tableOffset, const std::vector<ProjectSectionEntry> &table,
+                        std::uint32_t trackCount, double sampleRate, std::uint64_t liveBytes) {
+    out.seekp(static_cast<std::streamoff>(tableOffset));
+    out.write(reinterpret_cast<const char *>(table.data()),
+              static_cast<std::streamsize>(table.size() * sizeof(ProjectSectionEntry)));
+    out.flush(); // Everything the new header points at is written before the header
+    ProjectFileHeader header{};
+    std::memcpy(header.magic, projectMagic, sizeof(projectMagic));
+    header.version = projectVersion;
+    header.trackCount = trackCount;
+    header.sampleRate = sampleRate;
+    header.tableOffset = tableOffset;
+    header.tableEntries = table.size();
+    header.liveBytes = liveBytes;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.flush();
+}
+
+// Rewrites a project file without its dead sections, replacing it atomically
+static void compactProjectFile(const char *fileName) {
+    ProjectImage image = readImage(fileName);
+    std::string temporary = std::string(fileName) + ".compact";
+    std::fstream out(temporary, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + temporary);
+    }
+    out.write(std::string(sizeof(ProjectFileHeader), '\0').data(), sizeof(ProjectFileHeader));
+    std::uint64_t end = alignSection(sizeof(ProjectFileHeader));
+    std::unordered_map<std::uint64_t, std::uint64_t> moved; // Old offset to new offset
+    std::vector<ProjectSectionEntry> table = image.table;
+    for (ProjectSectionEntry &entry : table) {
+        auto found = moved.find(entry.offset);
+        if (found == moved.end()) {
+            out.seekp(static_cast<std::streamoff>(end));
+            out.write(reinterpret_cast<const char *>(image.file->data() + entry.offset),
+                      static_cast<std::streamsize>(entry.size));
+            found = moved.emplace(entry.offset, end).first;
+            end = alignSection(end + entry.size);
+        }
+        entry.offset = found->second;
+    }
+    finishImage(out, end, table, image.header.trackCount, image.header.sampleRate, image.header.liveBytes);
+    out.close();
+    if (out.fail() || std::rename(temporary.c_str(), fileName) != 0) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Failed to compact project file: " + std::string(fileName));
+    }
+}
+
+void saveProjectFile(const Project &project, const char *fileName, ProjectSaveCache &cache) {
+    std::lock_guard<std::mutex> saving(cache.saveMutex);
+
+    // Reuse the sections of an existing project file; anything else at the path is replaced
+    std::vector<ProjectSectionEntry> existing;
+    std::uint64_t size = 0;
+    bool incremental = false;
+    if (fileSize(fileName, size)) {
+        try {
+            existing = readImage(fileName).table;
+            incremental = true;
+        } catch (const std::exception &) {
+            existing.clear();
+        }
+    }
+    std::ios::openmode mode = std::ios::binary | std::ios::in | std::ios::out;
+    std::fstream out(fileName, incremental ? mode : mode | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + std::string(fileName));
+    }
+    if (!incremental) {
+        size = sizeof(ProjectFileHeader);
+        out.write(std::string(sizeof(ProjectFileHeader), '\0').data(), sizeof(ProjectFileHeader));
+    }
+
+    // New sections go past the end of the file, so nothing a loaded project maps is overwritten
+    ProjectWriter writer(out, cache, alignSection(size), existing);
+    std::vector<ProjectSectionEntry> table;
+    for (std::size_t t = 0; t < project.getTrackCount(); ++t) {
+        const Track &track = project.getTrack(t);
+        ProjectTrackRecord record{track.getSampleRate(), track.getClipCount()};
+        std::string payload(reinterpret_cast<const char *>(&record), sizeof(record));
+        for (std::size_t c = 0; c < track.getClipCount(); ++c) {
+            const TrackClip &clip = track.getClip(c);
+            ProjectClipRecord clipRecord{writer.placeSource(clip.audio), clip.position, clip.gain, 0};
+            payload.append(reinterpret_cast<const char *>(&clipRecord), sizeof(clipRecord));
+        }
+        table.push_back(writer.place(ProjectSectionKind::Track, payload));
+    }
+    std::uint64_t liveBytes = 0;
+    for (const ProjectSectionEntry &entry : writer.used) {
+        liveBytes += entry.size;
+        if (entry.kind != static_cast<std::uint32_t>(ProjectSectionKind::Track)) {
+            table.push_back(entry);
+        }
+    }
+    std::uint64_t tableOffset = writer.getEnd();
+    finishImage(out, tableOffset, table, static_cast<std::uint32_t>(project.getTrackCount()),
+                project.getSampleRate(), liveBytes);
+    out.close();
+    if (out.fail()) {
+        throw std::runtime_error("Failed to write project file: " + std::string(fileName));
+    }
+
+    std::uint64_t total = tableOffset + table.size() * sizeof(ProjectSectionEntry);
+    std::uint64_t dead = total - sizeof(ProjectFileHeader) - liveBytes;
+    if (incremental && dead > liveBytes && dead > compactionSlack) {
+        compactProjectFile(fileName);
+    }
+}
+
+// Recreates the source stored in a section
+static std::shared_ptr<const Audio> loadSource(const ProjectImage &image, const ProjectSectionEntry &entry,
+                                               ProjectSaveCache &cache) {
+    const std::string &path = image.file->getPath();
+    if (entry.kind == static_cast<std::uint32_t>(ProjectSectionKind::SourceEmbedded)) {
+        auto audio = std::make_shared<const ClipAudio>(image.file, entry.offset);
+        cache.remember(audio, entry.id);
+        return audio;
+    }
+    if (entry.kind != static_cast<std::uint32_t>(ProjectSectionKind::SourceReference)
+        || entry.size < sizeof(ProjectReferenceRecord)) {
+        throw std::runtime_error("Invalid project file: bad source section: " + path);
+    }
+    const char *bytes = reinterpret_cast<const char *>(image.file->data() + entry.offset);
+    ProjectReferenceRecord record{};
+    std::memcpy(&record, bytes, sizeof(record));
+    if (static_cast<std::uint64_t>(record.commandLength) + record.pathLength > entry.size - sizeof(record)) {
+        throw std::runtime_error("Invalid project file: truncated source reference: " + path);
+    }
+    std::string command(bytes + sizeof(record), record.commandLength);
+    std::string source(bytes + sizeof(record) + record.commandLength, record.pathLength);
+    if (!source.empty()) {
+        std::uint64_t size = 0;
+        if (!fileSize(source.c_str(), size)) {
+            throw std::runtime_error("Referenced file is missing: " + source);
+        }
+        if (size != record.fileSize || hashFile(source.c_str()) != record.fileHash) {
+            std::cerr << "Warning: " << source << " changed since the project was saved" << std::endl;
+        }
+    }
+    std::istringstream in(command + "\n");
+    return AudioFactory::getInstance().createShared(in);
+}
+
+Project loadProjectFile(const char *fileName, ProjectSaveCache &cache) {
+    ProjectImage image = readImage(fileName);
+    const std::string &path = image.file->getPath();
+    std::unordered_map<std::uint64_t, const ProjectSectionEntry *> sections;
+    for (std::size_t i = image.header.trackCount; i < image.table.size(); ++i) {
+        sections.emplace(image.table[i].id, &image.table[i]);
+    }
+    std::unordered_map<std::uint64_t, std::shared_ptr<const Audio>> sources;
+
+    Project project(image.header.sampleRate, 0);
+    for (std::uint32_t t = 0; t < image.header.trackCount; ++t) {
+        const ProjectSectionEntry &entry = image.table[t];
+        ProjectTrackRecord record{};
+        if (entry.kind != static_cast<std::uint32_t>(ProjectSectionKind::Track) || entry.size < sizeof(record)) {
+            throw std::runtime_error("Invalid project file: bad track section: " + path);
+        }
+        const unsigned char *bytes = image.file->data() + entry.offset;
+        std::memcpy(&record, bytes, sizeof(record));
+        if (record.clipCount > (entry.size - sizeof(record)) / sizeof(ProjectClipRecord)) {
+            throw std::runtime_error("Invalid project file: truncated track: " + path);
+        }
+
+        std::vector<TrackClip> clips;
+        clips.reserve(record.clipCount);
+        for (std::uint64_t c = 0; c < record.clipCount; ++c) {
+            ProjectClipRecord clipRecord{};
+            std::memcpy(&clipRecord, bytes + sizeof(record) + c * sizeof(clipRecord), sizeof(clipRecord));
+            std::shared_ptr<const Audio> &audio = sources[clipRecord.sourceId];
+            if (!audio) {
+                auto found = sections.find(clipRecord.sourceId);
+                if (found == sections.end()) {
+                    throw std::runtime_error("Invalid project file: missing source section: " + path);
+                }
+                audio = loadSource(image, *found->second, cache);
+            }
+            clips.push_back(TrackClip{audio, static_cast<std::size_t>(clipRecord.position),
+                                      static_cast<sample>(clipRecord.gain)});
+        }
+        Track &track = project.addTrack();
+        if (record.sampleRate != project.getSampleRate()) {
+            track = Track(static_cast<float>(record.sampleRate));
+        }
+        track.addClips(std::move(clips)); // All at once: the track is indexed once, not once per clip
+    }
+    return project;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file ProjectFile.hpp
+ * @brief Defines the versioned binary project format and its incremental writer and mapping reader.
+ */
+
+#ifndef DAW_PROJECTFILE_HPP
+#define DAW_PROJECTFILE_HPP
+
+#include "Project.hpp"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * @brief The fixed 64-byte header at the start of a project file.
+ *
+ * A project file is a header followed by 64-byte aligned sections and a section table. Every
+ * section is identified by the hash of its contents, so unchanged tracks and sources keep their
+ * bytes from one save to the next. Saves append the sections that changed and a new table, then
+ * rewrite this header to point at it; until then the previous table stays valid.
+ */
+struct ProjectFileHeader {
+    char magic[8];              ///< "DAWPROJ" followed by a zero byte.
+    std::uint32_t version;      ///< Format version, currently 1.
+    std::uint32_t trackCount;   ///< Number of track sections, listed first in the table.
+    double sampleRate;          ///< Master sample rate in Hz.
+    std::uint64_t tableOffset;  ///< Byte offset of the section table.
+    std::uint64_t tableEntries; ///< Number of entries in the section table.
+    std::uint64_t liveBytes;    ///< Total size of the sections in the table.
+    std::uint64_t reserved[2];  ///< Zero.
+};
+
+static_assert(sizeof(ProjectFileHeader) == 64, "The project header must stay 64 bytes");
+
+/**
+ * @brief The kinds of project file sections.
+ */
+enum class ProjectSectionKind : std::uint32_t {
+    Track = 1,           ///< A track: a `ProjectTrackRecord` followed by its `ProjectClipRecord`s.
+    SourceReference = 2, ///< A source recreated through the `AudioFactory`, with the hash of the file it reads.
+    SourceEmbedded = 3   ///< A source stored as a clip image, mapped in place on load.
+};
+
+/**
+ * @brief One entry of the section table.
+ */
+struct ProjectSectionEntry {
+    std::uint32_t kind;     ///< A `ProjectSectionKind`.
+    std::uint32_t reserved; ///< Zero.
+    std::uint64_t id;       ///< The content hash identifying the section.
+    std::uint64_t offset;   ///< Byte offset of the section, 64-byte aligned.
+    std::uint64_t size;     ///< Size of the section in bytes.
+};
+
+/**
+ * @brief The start of a track section.
+ */
+struct ProjectTrackRecord {
+    double sampleRate;        ///< The track sample rate in Hz.
+    std::uint64_t clipCount;  ///< The number of clip records that follow.
+};
+
+/**
+ * @brief One clip of a track section.
+ */
+struct ProjectClipRecord {
+    std::uint64_t sourceId; ///< The id of the source section.
+    std::uint64_t position; ///< The sample offset of the clip.
+    double gain;            ///< The clip gain.
+    std::uint64_t reserved; ///< Zero.
+};
+
+/**
+ * @brief The start of a source reference section, followed by the command and path bytes.
+ */
+struct ProjectReferenceRecord {
+    std::uint32_t commandLength; ///< Length of the `AudioFactory` command.
+    std::uint32_t pathLength;    ///< Length of the referenced file path, 0 if none.
+    std::uint64_t fileSize;      ///< Size of the referenced file when saved.
+    std::uint64_t fileHash;      ///< Content hash of the referenced file when saved.
+};
+
+/**
+ * @brief State kept between saves of one project and its snapshots.
+ *
+ * Remembers the section id of every embedded source already written or loaded, so later
+ * saves recognise unchanged sources without rendering them again. Also serializes saves.
+ */
+class ProjectSaveCache {
+private:
+    /**
+     * @brief A cached embedded source id, valid while the source is alive.
+     */
+    struct Entry {
+        std::weak_ptr<const Audio> audio; ///< The source the id belongs to.
+        std::uint64_t id;                 ///< The id of its clip image section.
+    };
+
+    std::unordered_map<const Audio *, Entry> embedded; ///< Known embedded sources.
+    std::mutex mutex;                                  ///< Guards `embedded`.
+
+public:
+    std::mutex saveMutex; ///< Held for the whole of a save.
+
+    /**
+     * @brief Looks up the section id of an embedded source.
+     * @param audio The source.
+     * @param id Set to the id if known.
+     * @return True if the source is known.
+     */
+    bool find(const std::shared_ptr<const Audio> &audio, std::uint64_t &id);
+
+    /**
+     * @brief Records the section id of an embedded source.
+     * @param audio The source.
+     * @param id The id of its clip image section.
+     */
+    void remember(const std::shared_ptr<const Audio> &audio, std::uint64_t id);
+};
+
+/**
+ * @brief Saves a project, reusing the unchanged sections of an existing file.
+ *
+ * If `fileName` is already a project file, only new sections are appended, followed by a new
+ * table and header; everything else stays in place, so files mapped by loaded projects remain
+ * valid. Once more than half the file is dead the project is rewritten to a new file, which
+ * replaces the old one atomically.
+ * @param project The project to save.
+ * @param fileName The path of the project file.
+ * @param cache The save cache of the project.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void saveProjectFile(const Project &project, const char *fileName, ProjectSaveCache &cache);
+
+/**
+ * @brief Loads a project file.
+ *
+ * The file is mapped and embedded sources are read from the mapping in place. Referenced
+ * sources are recreated through the `AudioFactory`; a warning is printed if their file
+ * changed since the save.
+ * @param fileName The path of the project file.
+ * @param cache The save cache to fill with the ids of the embedded sources.
+ * @return The loaded project.
+ * @throws std::runtime_error if the file is not a valid project.
+ */
+Project loadProjectFile(const char *fileName, ProjectSaveCache &cache);
+
+#endif //DAW_PROJECTFILE_HPP
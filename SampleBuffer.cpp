@@ -0,0 +1,138 @@
+#include "SampleBuffer.hpp"
+#include <atomic>
+#include <stdexcept>
+
+void SampleBuffer::Storage::refresh() {
+    pointers.resize(planes.size());
+    for (std::size_t c = 0; c < planes.size(); ++c) {
+        pointers[c] = planes[c].data();
+    }
+}
+
+SampleBuffer::SampleBuffer() : SampleBuffer(0, 1) {
+
+}
+
+SampleBuffer::SampleBuffer(std::size_t size, unsigned channels) : storage(std::make_shared<Storage>()) {
+    if (channels == 0) {
+        throw std::invalid_argument("SampleBuffer requires at least one channel.");
+    }
+    storage->planes.assign(channels, AlignedSamples(size));
+    storage->refresh();
+}
+
+SampleBuffer::SampleBuffer(const SampleBuffer &other)
+        : storage(other.unshareable ? copyStorage(other) : other.storage) {}
+
+SampleBuffer &SampleBuffer::operator=(const SampleBuffer &other) {
+    if (this != &other) {
+        this->storage = other.unshareable ? copyStorage(other) : other.storage;
+        this->unshareable = false;
+    }
+    return *this;
+}
+
+std::shared_ptr<SampleBuffer::Storage> SampleBuffer::copyStorage(const SampleBuffer &other) {
+    auto copy = std::make_shared<Storage>();
+    copy->planes = other.storage->planes;
+    copy->refresh();
+    if (!other.unshareable) {
+        copy->stats = std::atomic_load(&other.storage->stats);
+    }
+    return copy;
+}
+
+void SampleBuffer::detach() {
+    // A count of 1 cannot grow behind our back: only this buffer holds the storage, and copying
+    // it concurrently with a write is a race in the caller. It can drop from 2 to 1 when another
+    // thread releases its copy; the acquire fence orders that thread's last reads before our writes.
+    if (storage.use_count() > 1) {
+        storage = copyStorage(*this);
+    } else {
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+}
+
+std::size_t SampleBuffer::size() const {
+    return storage->planes.front().size();
+}
+
+unsigned SampleBuffer::channels() const {
+    return static_cast<unsigned>(storage->planes.size());
+}
+
+const sample *SampleBuffer::data(unsigned channel) const {
+    return storage->pointers[channel];
+}
+
+const sample *const *SampleBuffer::planes() const {
+    return storage->pointers.data();
+}
+
+sample *SampleBuffer::mutableData(unsigned channel) {
+    return this->mutablePlanes()[channel];
+}
+
+sample *const *SampleBuffer::mutablePlanes() {
+    detach();
+    std::atomic_store(&storage->stats, std::shared_ptr<const AudioStats>());
+    return storage->pointers.data();
+}
+
+sample &SampleBuffer::mutableAt(std::size_t index) {
+    sample &value = this->mutablePlanes()[0][index];
+    this->unshareable = true;
+    return value;
+}
+
+const sample &SampleBuffer::operator[](std::size_t index) const {
+    return storage->pointers[0][index];
+}
+
+void SampleBuffer::resize(std::size_t size) {
+    detach();
+    for (AlignedSamples &plane : storage->planes) {
+        plane.resize(size);
+    }
+    storage->refresh();
+    std::atomic_store(&storage->stats, std::shared_ptr<const AudioStats>());
+}
+
+bool SampleBuffer::isShared() const {
+    return storage.use_count() > 1;
+}
+
+std::shared_ptr<const AudioStats> SampleBuffer::getStats() const {
+    return unshareable ? nullptr : std::atomic_load(&storage->stats);
+}
+
+void SampleBuffer::setStats(std::shared_ptr<const AudioStats> stats) const {
+    if (!unshareable) {
+        std::atomic_store(&storage->stats, std::move(stats));
+    }
+}
+
+// Planes are padded to a whole number of cache lines so each one starts aligned
+static std::size_t planeStride(std::size_t frames) {
+    constexpr std::size_t perLine = 64 / sizeof(sample);
+    return (frames + perLine - 1) / perLine * perLine;
+}
+
+PlanarBlock::PlanarBlock(unsigned channels, std::size_t frames)
+        : stride(planeStride(frames)), storage(stride * channels), pointers(channels) {
+    for (unsigned c = 0; c < channels; ++c) {
+        pointers[c] = storage.data() + c * stride;
+    }
+}
+
+sample *const *PlanarBlock::planes() const {
+    return pointers.data();
+}
+
+sample *PlanarBlock::operator[](unsigned channel) const {
+    return pointers[channel];
+}
+
+unsigned PlanarBlock::channels() const {
+    return static_cast<unsigned>(pointers.size());
+}
@@ -0,0 +1,271 @@
+/**
+ * @file SampleBuffer.hpp
+ * @brief Defines the SampleBuffer class, a reference-counted copy-on-write planar sample store,
+ *        and the PlanarBlock scratch buffer used for planar `render()` calls.
+ */
+
+#ifndef DAW_SAMPLEBUFFER_HPP
+#define DAW_SAMPLEBUFFER_HPP
+
+#include "Audio.hpp"
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+/**
+ * @brief A minimal allocator that aligns every allocation, so sample planes start on a cache line.
+ * @tparam T The element type.
+ * @tparam Alignment The alignment in bytes.
+ */
+template<typename T, std::size_t Alignment = 64>
+struct AlignedAllocator {
+    using value_type = T; ///< The element type.
+
+    /**
+     * @brief Rebinds the allocator to another element type with the same alignment.
+     */
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>; ///< The rebound allocator.
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+    /**
+     * @brief Allocates aligned storage for `n` elements.
+     * @param n The number of elements.
+     * @return The allocated storage.
+     */
+    T *allocate(std::size_t n) {
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    /**
+     * @brief Releases storage obtained from `allocate()`.
+     * @param p The storage to release.
+     */
+    void deallocate(T *p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    friend bool operator==(const AlignedAllocator &, const AlignedAllocator &) { return true; }
+
+    friend bool operator!=(const AlignedAllocator &, const AlignedAllocator &) { return false; }
+};
+
+/// @brief A vector of samples whose storage is cache-line aligned.
+using AlignedSamples = std::vector<sample, AlignedAllocator<sample>>;
+
+/**
+ * @brief A reference-counted, copy-on-write buffer of planar (one array per channel) samples.
+ *
+ * Copying a SampleBuffer is O(1): both copies share the same storage until one of them
+ * asks for mutable access, at which point that copy detaches with its own private storage.
+ * Each channel is a separate, cache-line aligned plane, so per-channel kernels run on
+ * contiguous data. The storage also carries a cache of its level statistics, so every
+ * copy benefits from an analysis made through any of them.
+ */
+class SampleBuffer {
+private:
+    /**
+     * @brief The shared storage block.
+     */
+    struct Storage {
+        std::vector<AlignedSamples> planes;        ///< One sample array per channel, all the same length.
+        std::vector<sample *> pointers;            ///< Pointers to the start of each plane.
+        std::shared_ptr<const AudioStats> stats;   ///< Cached statistics of `planes`, if computed.
+
+        /**
+         * @brief Refreshes `pointers` after the planes were created, copied or resized.
+         */
+        void refresh();
+    };
+
+    std::shared_ptr<Storage> storage; ///< The (possibly shared) storage.
+    bool unshareable = false;         ///< Set once a lasting sample reference was handed out by `mutableAt()`.
+
+    /**
+     * @brief Makes this buffer the sole owner of its storage, copying it if it is shared.
+     */
+    void detach();
+
+    /**
+     * @brief Makes a private copy of another buffer's storage.
+     * @param other The buffer to copy.
+     * @return The new storage.
+     */
+    static std::shared_ptr<Storage> copyStorage(const SampleBuffer &other);
+
+public:
+    /**
+     * @brief Constructs an empty mono buffer.
+     */
+    SampleBuffer();
+
+    /**
+     * @brief Constructs a zero-filled buffer.
+     * @param size The number of samples per channel.
+     * @param channels The number of channels.
+     */
+    explicit SampleBuffer(std::size_t size, unsigned channels = 1);
+
+    /**
+     * @brief Copies a buffer, sharing its storage unless `mutableAt()` was called on it.
+     * @param other The buffer to copy.
+     */
+    SampleBuffer(const SampleBuffer &other);
+
+    /**
+     * @brief Moves a buffer, taking over its storage and its unshareable state.
+     * @param other The buffer to move from.
+     */
+    SampleBuffer(SampleBuffer &&other) noexcept = default;
+
+    /**
+     * @brief Copy-assigns a buffer, sharing its storage unless `mutableAt()` was called on it.
+     * @param other The buffer to copy.
+     * @return A reference to this buffer.
+     */
+    SampleBuffer &operator=(const SampleBuffer &other);
+
+    /**
+     * @brief Move-assigns a buffer.
+     * @param other The buffer to move from.
+     * @return A reference to this buffer.
+     */
+    SampleBuffer &operator=(SampleBuffer &&other) noexcept = default;
+
+    /**
+     * @brief Gets the number of samples per channel.
+     * @return The number of samples per channel.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Gets the number of channels.
+     * @return The number of channels.
+     */
+    unsigned channels() const;
+
+    /**
+     * @brief Gets read-only access to one channel.
+     * @param channel The channel (not bounds checked).
+     * @return A pointer to the first sample of the channel.
+     */
+    const sample *data(unsigned channel = 0) const;
+
+    /**
+     * @brief Gets read-only access to all channels.
+     * @return An array of `channels()` plane pointers.
+     */
+    const sample *const *planes() const;
+
+    /**
+     * @brief Gets writable access to one channel, detaching from other copies first.
+     *
+     * Also drops the cached statistics, since the caller may change the samples.
+     * As with `mutablePlanes()`, the pointer must not be kept past the next copy of this buffer.
+     * @param channel The channel (not bounds checked).
+     * @return A pointer to the first sample of the channel.
+     */
+    sample *mutableData(unsigned channel = 0);
+
+    /**
+     * @brief Gets writable access to all channels, detaching from other copies first.
+     *
+     * Also drops the cached statistics, since the caller may change the samples.
+     * The pointers are only for immediate writes: a later copy of this buffer shares the storage,
+     * so they must not be kept past the next copy. Use `mutableAt()` for a lasting reference.
+     * @return An array of `channels()` plane pointers, suitable for `Audio::render()`.
+     */
+    sample *const *mutablePlanes();
+
+    /**
+     * @brief Gets a writable reference to a sample of the first channel that may be kept.
+     *
+     * Detaches, drops the cached statistics and marks this buffer unshareable: from then on,
+     * copies of it get their own storage instead of sharing one the reference can still write
+     * to, and statistics are no longer cached, since they could go stale at any time.
+     * @param index The index of the sample (not bounds checked).
+     * @return A reference to the sample, valid until the buffer is resized or destroyed.
+     */
+    sample &mutableAt(std::size_t index);
+
+    /**
+     * @brief Reads a sample of the first channel.
+     * @param index The index of the sample (not bounds checked).
+     * @return The sample value.
+     */
+    const sample &operator[](std::size_t index) const;
+
+    /**
+     * @brief Resizes every channel, detaching from other copies first. New samples are zero.
+     * @param size The new number of samples per channel.
+     */
+    void resize(std::size_t size);
+
+    /**
+     * @brief Checks whether the storage is shared with other buffers.
+     * @return True if another SampleBuffer references the same storage.
+     */
+    bool isShared() const;
+
+    /**
+     * @brief Gets the cached statistics of the samples.
+     * @return The cached statistics, or nullptr if they have not been computed or the buffer is unshareable.
+     */
+    std::shared_ptr<const AudioStats> getStats() const;
+
+    /**
+     * @brief Caches statistics for the current samples, shared with every copy of this buffer.
+     *
+     * Ignored for unshareable buffers.
+     * @param stats The statistics to cache.
+     */
+    void setStats(std::shared_ptr<const AudioStats> stats) const;
+};
+
+/**
+ * @brief A scratch buffer holding one block per channel, for planar `render()` calls.
+ *
+ * All planes live in one aligned allocation, each starting on a cache line.
+ */
+class PlanarBlock {
+private:
+    std::size_t stride;              ///< Distance between planes, in samples.
+    AlignedSamples storage;          ///< The sample storage for all planes.
+    std::vector<sample *> pointers;  ///< Pointers to the start of each plane.
+
+public:
+    /**
+     * @brief Constructs a zero-filled block.
+     * @param channels The number of channels.
+     * @param frames The number of samples per channel.
+     */
+    explicit PlanarBlock(unsigned channels, std::size_t frames = Audio::blockSize);
+
+    /**
+     * @brief Gets the plane pointers.
+     * @return An array of `channels()` plane pointers, suitable for `Audio::render()`.
+     */
+    sample *const *planes() const;
+
+    /**
+     * @brief Gets one plane.
+     * @param channel The channel (not bounds checked).
+     * @return A pointer to the first sample of the channel.
+     */
+    sample *operator[](unsigned channel) const;
+
+    /**
+     * @brief Gets the number of channels.
+     * @return The number of channels.
+     */
+    unsigned channels() const;
+};
+
+#endif //DAW_SAMPLEBUFFER_HPP
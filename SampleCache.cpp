@@ -0,0 +1,101 @@
+#include "SampleCache.hpp"
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <sys/stat.h>
+
+SampleCache::SampleCache() {
+    const char *env = std::getenv("DAW_SAMPLE_CACHE_MB");
+    std::size_t megabytes = env ? static_cast<std::size_t>(std::strtoul(env, nullptr, 10)) : 256;
+    this->stats.budget = megabytes << 20;
+}
+
+SampleCache &SampleCache::getInstance() {
+    static SampleCache cache;
+    return cache;
+}
+
+void SampleCache::erase(std::unordered_map<std::string, Entry>::iterator found) {
+    this->stats.bytes -= found->second.bytes;
+    this->order.erase(found->second.use);
+    this->entries.erase(found);
+    this->stats.entries = this->entries.size();
+}
+
+void SampleCache::trim() {
+    while (this->stats.bytes > this->stats.budget && !this->order.empty()) {
+        this->erase(this->entries.find(this->order.back()));
+        ++this->stats.evictions;
+    }
+}
+
+FileAudio *SampleCache::load(const char *fileName) {
+    if (!fileName) {
+        throw std::runtime_error("File name is null.");
+    }
+    char resolved[PATH_MAX];
+    struct stat info{};
+    if (!::realpath(fileName, resolved) || ::stat(resolved, &info) != 0) {
+        throw std::runtime_error("Failed to open audio file: " + std::string(fileName)
+                                 + " (" + std::strerror(errno) + ")");
+    }
+    std::string path = resolved;
+    Entry entry;
+    entry.size = static_cast<std::uint64_t>(info.st_size);
+    entry.modifiedSec = static_cast<std::int64_t>(info.st_mtim.tv_sec);
+    entry.modifiedNsec = static_cast<std::int64_t>(info.st_mtim.tv_nsec);
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto found = this->entries.find(path);
+        if (found != this->entries.end()) {
+            const Entry &cached = found->second;
+            if (cached.size == entry.size && cached.modifiedSec == entry.modifiedSec
+                && cached.modifiedNsec == entry.modifiedNsec) {
+                this->order.splice(this->order.begin(), this->order, cached.use);
+                ++this->stats.hits;
+                return cached.audio->clone();
+            }
+            this->erase(found); // Changed on disk
+        }
+        ++this->stats.misses;
+    }
+
+    // Decode outside the lock, so loads of different files run concurrently. Loaded by the
+    // canonical path, so every clone names the file the same way whichever spelling asked for it
+    entry.audio = std::make_shared<const FileAudio>(path.c_str());
+    entry.bytes = entry.audio->getSampleSize() * entry.audio->getChannels() * sizeof(sample);
+    FileAudio *loaded = entry.audio->clone();
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (entry.bytes > this->stats.budget || this->entries.count(path) != 0) {
+        return loaded; // Too large to keep, or cached meanwhile by a concurrent load
+    }
+    this->order.push_front(path);
+    entry.use = this->order.begin();
+    this->stats.bytes += entry.bytes;
+    this->entries.emplace(path, std::move(entry));
+    this->stats.entries = this->entries.size();
+    this->trim();
+    return loaded;
+}
+
+void SampleCache::setBudget(std::size_t bytes) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stats.budget = bytes;
+    this->trim();
+}
+
+void SampleCache::clear() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->entries.clear();
+    this->order.clear();
+    this->stats.entries = 0;
+    this->stats.bytes = 0;
+}
+
+SampleCacheStats SampleCache::getStats() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->stats;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file SampleCache.hpp
+ * @brief Defines the SampleCache class, a process-wide LRU cache of decoded audio files.
+ */
+
+#ifndef DAW_SAMPLECACHE_HPP
+#define DAW_SAMPLECACHE_HPP
+
+#include "FileAudio.hpp"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Counters and usage of the SampleCache.
+ */
+struct SampleCacheStats {
+    std::uint64_t hits = 0;      ///< Loads served from the cache.
+    std::uint64_t misses = 0;    ///< Loads that decoded the file.
+    std::uint64_t evictions = 0; ///< Entries dropped to stay within the budget.
+    std::size_t entries = 0;     ///< Files currently cached.
+    std::size_t bytes = 0;       ///< Sample bytes currently cached.
+    std::size_t budget = 0;      ///< The memory budget in bytes.
+};
+
+/**
+ * @brief A process-wide cache of decoded audio files, evicting the least recently used.
+ *
+ * Files are keyed by canonical path, size and modification time, so a file that changed on disk
+ * is decoded again while renaming or re-opening an unchanged one is not. Hits return a clone of
+ * the decoded `FileAudio`, which shares its copy-on-write sample buffer, so a hit costs no
+ * decoding and no copy. The budget counts the samples held by the cache itself; it is 256 MiB
+ * unless set with `setBudget()` or the `DAW_SAMPLE_CACHE_MB` environment variable.
+ */
+class SampleCache {
+private:
+    /**
+     * @brief A decoded file and the file state it was decoded from.
+     */
+    struct Entry {
+        std::uint64_t size = 0;                  ///< The file size in bytes.
+        std::int64_t modifiedSec = 0;            ///< The modification time, seconds part.
+        std::int64_t modifiedNsec = 0;           ///< The modification time, nanoseconds part.
+        std::shared_ptr<const FileAudio> audio;  ///< The decoded file.
+        std::size_t bytes = 0;                   ///< The sample bytes of `audio`.
+        std::list<std::string>::iterator use;    ///< The position of the path in `order`.
+    };
+
+    std::unordered_map<std::string, Entry> entries; ///< The cached files, keyed by canonical path.
+    std::list<std::string> order;                   ///< Cached paths, most recently used first.
+    SampleCacheStats stats;                         ///< The counters, with `entries` and `bytes` kept current.
+    mutable std::mutex mutex;                       ///< Guards everything above.
+
+    /**
+     * @brief Constructs the cache with the budget from the environment.
+     */
+    SampleCache();
+
+    /**
+     * @brief Deleted copy constructor to prevent copying.
+     */
+    SampleCache(const SampleCache &other) = delete;
+
+    /**
+     * @brief Deleted assignment operator to prevent assignment.
+     */
+    SampleCache &operator=(const SampleCache &other) = delete;
+
+    /**
+     * @brief Removes a cached file. The lock must be held.
+     * @param found The entry to remove.
+     */
+    void erase(std::unordered_map<std::string, Entry>::iterator found);
+
+    /**
+     * @brief Evicts least recently used files until the cache fits its budget. The lock must be held.
+     */
+    void trim();
+
+public:
+    /**
+     * @brief Gets the process-wide cache.
+     * @return A reference to the SampleCache instance.
+     */
+    static SampleCache &getInstance();
+
+    /**
+     * @brief Loads a file, decoding it only if it is not cached or changed since it was cached.
+     * @param fileName The path of a WAV or TXT file.
+     * @return A new FileAudio sharing the decoded samples, named by the file's canonical path.
+     * @throws std::runtime_error if the file cannot be read or decoded.
+     */
+    FileAudio *load(const char *fileName);
+
+    /**
+     * @brief Sets the memory budget, evicting files if the cache is now over it.
+     * @param bytes The most sample bytes to keep; 0 disables caching.
+     */
+    void setBudget(std::size_t bytes);
+
+    /**
+     * @brief Drops every cached file. Counters are kept.
+     */
+    void clear();
+
+    /**
+     * @brief Gets the counters and current usage.
+     * @return A snapshot of the statistics.
+     */
+    SampleCacheStats getStats() const;
+};
+
+#endif //DAW_SAMPLECACHE_HPP
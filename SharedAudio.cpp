@@ -0,0 +1,96 @@
+#include "SharedAudio.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+SharedAudio::SharedAudio(std::shared_ptr<const Audio> source) : Audio(), source(std::move(source)) {
+    if (!this->source) {
+        throw std::invalid_argument("SharedAudio requires a node.");
+    }
+    this->duration = this->source->getDuration();
+    this->sampleRate = this->source->getSampleRate();
+    this->sampleSize = this->source->getSampleSize();
+    this->channels = this->source->getChannels();
+}
+
+SharedAudio::SharedAudio(const SharedAudio &other)
+        : Audio(other), source(other.source), shared(other.shared.load(std::memory_order_relaxed)) {}
+
+const std::shared_ptr<const Audio> &SharedAudio::getNode() const {
+    return this->source;
+}
+
+void SharedAudio::markShared() const {
+    this->shared.store(true, std::memory_order_relaxed);
+}
+
+sample SharedAudio::operator[](std::size_t i) const {
+    return (*this->source)[i];
+}
+
+sample &SharedAudio::operator[](std::size_t /*i*/) {
+    throw std::logic_error("SharedAudio does not support sample modification.");
+}
+
+void SharedAudio::render(std::size_t start, std::size_t count, sample *const *out) const {
+    if (count == 0 || count > Audio::blockSize || !this->shared.load(std::memory_order_relaxed)) {
+        this->source->render(start, count, out);
+        return;
+    }
+    unsigned channels = this->channels;
+    std::shared_ptr<PlanarBlock> block;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        for (Slot &slot : this->slots) {
+            if (slot.count == count && slot.start == start) {
+                slot.used = ++this->clock;
+                block = slot.block;
+                break;
+            }
+        }
+    }
+    if (block) {
+        for (unsigned c = 0; c < channels; ++c) {
+            std::copy((*block)[c], (*block)[c] + count, out[c]);
+        }
+        return;
+    }
+
+    this->source->render(start, count, out);
+    std::lock_guard<std::mutex> lock(this->mutex);
+    Slot &victim = *std::min_element(this->slots.begin(), this->slots.end(),
+                                     [](const Slot &a, const Slot &b) { return a.used < b.used; });
+    // Reuse the evicted planes unless a reader is still copying from them
+    if (!victim.block || victim.block.use_count() != 1) {
+        victim.block = std::make_shared<PlanarBlock>(channels);
+    }
+    for (unsigned c = 0; c < channels; ++c) {
+        std::copy(out[c], out[c] + count, (*victim.block)[c]);
+    }
+    victim.start = start;
+    victim.count = count;
+    victim.used = ++this->clock;
+}
+
+AudioRegion SharedAudio::describeRegion(std::size_t start, std::size_t count) const {
+    return this->source->describeRegion(start, count);
+}
+
+AudioStats SharedAudio::analyze() const {
+    return this->source->analyze();
+}
+
+bool SharedAudio::isRandomAccess() const {
+    return this->source->isRandomAccess();
+}
+
+bool SharedAudio::getSource(AudioSource &source) const {
+    return this->source->getSource(source);
+}
+
+SharedAudio *SharedAudio::clone() const {
+    return new SharedAudio(*this);
+}
+
+std::ostream &SharedAudio::printToStream(std::ostream &out) const {
+    return this->source->printToStream(out);
+}
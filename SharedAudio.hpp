@@ -0,0 +1,139 @@
+/**
+ * @file SharedAudio.hpp
+ * @brief Defines the SharedAudio class, a graph node shared by several consumers that renders each block once.
+ */
+
+#ifndef DAW_SHAREDAUDIO_HPP
+#define DAW_SHAREDAUDIO_HPP
+
+#include "Audio.hpp"
+#include "SampleBuffer.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+/**
+ * @brief Wraps a node that several parts of a graph use, so each block of it is computed once.
+ *
+ * The `AudioFactory` gives structurally identical sub-graphs one instance wrapped in a
+ * SharedAudio. Consumers rendering the same block one after another, as a mix does, get copies
+ * of the first render instead of evaluating the sub-graph again. The last few blocks are kept,
+ * so consumers running on different threads still hit while they work on nearby blocks.
+ * Memoizing costs a lock and a copy per block, so it starts only once the node has a second
+ * consumer; until then blocks are rendered straight from the node.
+ */
+class SharedAudio : public Audio {
+private:
+    /**
+     * @brief A memoized block.
+     */
+    struct Slot {
+        std::size_t start = 0;               ///< The first sample of the block.
+        std::size_t count = 0;               ///< The samples per channel, 0 if the slot is empty.
+        std::uint64_t used = 0;              ///< When the slot was last used, for replacement.
+        std::shared_ptr<PlanarBlock> block;  ///< The rendered planes, shared so readers copy outside the lock.
+    };
+
+    /// @brief The number of blocks kept.
+    static constexpr std::size_t slotCount = 4;
+
+    std::shared_ptr<const Audio> source;       ///< The shared node.
+    mutable std::array<Slot, slotCount> slots; ///< The most recently rendered blocks.
+    mutable std::uint64_t clock = 0;           ///< Counts slot uses.
+    mutable std::mutex mutex;                  ///< Guards `slots` and `clock`.
+    mutable std::atomic<bool> shared{false};   ///< Set once the node has a second consumer.
+
+public:
+    /**
+     * @brief Wraps a node.
+     * @param source The node to share. Must not be null.
+     * @throws std::invalid_argument if the node is null.
+     */
+    explicit SharedAudio(std::shared_ptr<const Audio> source);
+
+    /**
+     * @brief Copy constructor; the copy shares the node but starts with no memoized blocks.
+     *
+     * The copy memoizes if the original does.
+     * @param other The SharedAudio to copy.
+     */
+    SharedAudio(const SharedAudio &other);
+
+    /**
+     * @brief Gets the shared node.
+     * @return The node.
+     */
+    const std::shared_ptr<const Audio> &getNode() const;
+
+    /**
+     * @brief Records that the node has another consumer, so its blocks are memoized from now on.
+     */
+    void markShared() const;
+
+    /**
+     * @brief Gets a sample of the first channel from the shared node.
+     * @param i The sample index.
+     * @return The sample.
+     */
+    sample operator[](std::size_t i) const override;
+
+    /**
+     * @brief Accesses a sample (non-const version).
+     * @throws std::logic_error as shared nodes are immutable.
+     * @param i The sample index (unused).
+     * @return A reference to a sample (never actually returns due to exception).
+     */
+    sample &operator[](std::size_t i) override;
+
+    /**
+     * @brief Renders a block, from memory if it was rendered recently.
+     * @param start The index of the first sample to render.
+     * @param count The number of samples to render per channel.
+     * @param out One destination plane per channel.
+     */
+    void render(std::size_t start, std::size_t count, sample *const *out) const override;
+
+    /**
+     * @brief Describes a range of the shared node.
+     * @param start The index of the first sample of the range.
+     * @param count The number of samples in the range.
+     * @return The node's description.
+     */
+    AudioRegion describeRegion(std::size_t start, std::size_t count) const override;
+
+    /**
+     * @brief Analyzes the shared node.
+     * @return The node's statistics.
+     */
+    AudioStats analyze() const override;
+
+    /**
+     * @brief Checks whether the shared node can be rendered in any order.
+     * @return The node's answer.
+     */
+    bool isRandomAccess() const override;
+
+    /**
+     * @brief Describes how to recreate the shared node.
+     * @param source Set to the node's source.
+     * @return The node's answer.
+     */
+    bool getSource(AudioSource &source) const override;
+
+    /**
+     * @brief Clones the SharedAudio object.
+     * @return A pointer to a new SharedAudio sharing the same node.
+     */
+    SharedAudio *clone() const override;
+
+    /**
+     * @brief Prints the shared node to an output stream.
+     * @param out The output stream.
+     * @return A reference to the output stream.
+     */
+    std::ostream &printToStream(std::ostream &out) const override;
+};
+
+#endif //DAW_SHAREDAUDIO_HPP
@@ -1,27 +1,63 @@
 #include "Silence.hpp"
+#include <algorithm>
+#include <cmath>
+#include <string>
 
 Silence::Silence(double duration, float sampleRate) : Audio() {
     this->duration = duration;
     this->sampleRate = sampleRate;
+    this->sampleSize = static_cast<size_t>(std::llround(duration * sampleRate));
 }
 
-double Silence::operator[](size_t index) const {
+sample Silence::operator[](size_t index) const {
     return 0;
 }
 
-double &Silence::operator[](size_t index) {
+sample &Silence::operator[](size_t index) {
     throw std::logic_error("Can not access");
 }
 
+void Silence::render(std::size_t /*start*/, std::size_t count, sample *const *out) const {
+    for (unsigned c = 0; c < this->channels; ++c) {
+        std::fill(out[c], out[c] + count, 0.0);
+    }
+}
+
+AudioRegion Silence::describeRegion(std::size_t /*start*/, std::size_t /*count*/) const {
+    AudioRegion region;
+    region.constant = true;
+    return region;
+}
+
+AudioStats Silence::analyze() const {
+    return AudioStats{};
+}
+
 Silence *Silence::clone() const {
     return new Silence(*this);
 }
 
+bool Silence::getSource(AudioSource &source) const {
+    std::ostringstream command;
+    command.precision(17); // Round-trips the duration exactly
+    command << "SLNC " << this->duration << ' ' << this->sampleRate << ' ' << this->sampleSize;
+    source.command = command.str();
+    source.path.clear();
+    return true;
+}
+
 std::ostream &Silence::printToStream(std::ostream &out) const {
     out << this->duration << ' ' << this->sampleRate << ' ' << this->sampleSize << ' ';
-    for (int i = 0; i < sampleSize; ++i) {
-//        TODO maybe fix this implementation
-        out << 0 << ' ';
+    // Write the zeros a block of text at a time instead of one insertion per sample
+    std::string zeros;
+    for (std::size_t i = 0; i < Audio::blockSize; ++i) {
+        zeros += "0 ";
+    }
+    std::size_t remaining = this->sampleSize * this->channels;
+    while (remaining > 0) {
+        std::size_t n = std::min(remaining, Audio::blockSize);
+        out.write(zeros.data(), static_cast<std::streamsize>(2 * n));
+        remaining -= n;
     }
     out << std::endl;
     return out;
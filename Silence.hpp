@@ -18,6 +18,8 @@ class Silence : public Audio {
 public:
     /**
      * @brief Constructs a Silence object.
+     *
+     * The sample size is the duration times the sample rate, rounded to the nearest sample.
      * @param duration The duration of the silence in seconds.
      * @param sampleRate The sample rate of the audio in Hz.
      */
@@ -31,7 +33,7 @@ public:
      * @return Always 0.0 for silence.
      * @throws std::out_of_range if index is out of bounds (behavior inherited from Audio or should be checked).
      */
-    double operator[](size_t index) const override;
+    sample operator[](size_t index) const override;
 
     /**
      * @brief Accesses a sample at the given index (non-const version).
@@ -39,7 +41,36 @@ public:
      * @param index The sample index (unused).
      * @return A reference to a sample (never actually returns due to exception).
      */
-    double &operator[](size_t index) override;
+    sample &operator[](size_t index) override;
+
+    /**
+     * @brief Renders a block of silence.
+     * @param start The index of the first sample to render (unused).
+     * @param count The number of samples to render per channel.
+     * @param out One destination plane per channel, each filled with 0.0.
+     */
+    void render(std::size_t start, std::size_t count, sample *const *out) const override;
+
+    /**
+     * @brief Describes a range of silence.
+     * @param start The index of the first sample of the range (unused).
+     * @param count The number of samples in the range (unused).
+     * @return A silent region, so consumers never need to render it.
+     */
+    AudioRegion describeRegion(std::size_t start, std::size_t count) const override;
+
+    /**
+     * @brief Gets the level of silence without scanning it.
+     * @return Zero peak and RMS.
+     */
+    AudioStats analyze() const override;
+
+    /**
+     * @brief Gets the command that recreates this silence.
+     * @param source Receives the "SLNC" command with the duration, rate and length; no path.
+     * @return Always true.
+     */
+    bool getSource(AudioSource &source) const override;
 
     /**
      * @brief Clones the Silence object.
@@ -0,0 +1,155 @@
+#include "StreamAudio.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+/// Largest read issued to the stream at once
+static constexpr std::size_t readBlockBytes = 1 << 20;
+
+StreamAudio::Input::Input(std::istream &in, const WavFormat &format) : in(in), format(format) {
+
+}
+
+StreamAudio::StreamAudio(std::istream &in) : Audio() {
+    try {
+        WavFormat format = readWavHeader(in);
+        if (format.dataSize == 0 || format.dataSize == 0xFFFFFFFFu) { // Length not known when the header was written
+            format.dataSize = std::numeric_limits<std::uint64_t>::max();
+        }
+        input = std::make_shared<Input>(in, format);
+    } catch (const std::exception &ex) {
+        std::cerr << "Error reading WAV stream: " << ex.what() << std::endl;
+        throw;
+    }
+    this->initialize();
+}
+
+StreamAudio::StreamAudio(std::istream &in, WavEncoding encoding, unsigned channels, unsigned sampleRate,
+                         unsigned bitsPerSample) : Audio() {
+    bool supported = (encoding == WavEncoding::PCM)
+                     ? (bitsPerSample == 8 || bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32)
+                     : (bitsPerSample == 32 || bitsPerSample == 64);
+    if (!supported || channels == 0 || sampleRate == 0) {
+        throw std::invalid_argument("Unsupported raw stream format: " + std::to_string(channels) + " channels, " +
+                                    std::to_string(bitsPerSample) + "-bit " +
+                                    (encoding == WavEncoding::PCM ? "PCM" : "float"));
+    }
+    WavFormat format;
+    format.encoding = encoding;
+    format.channels = channels;
+    format.sampleRate = sampleRate;
+    format.bitsPerSample = bitsPerSample;
+    format.blockAlign = channels * (bitsPerSample / 8);
+    format.dataSize = std::numeric_limits<std::uint64_t>::max();
+    input = std::make_shared<Input>(in, format);
+    this->initialize();
+}
+
+void StreamAudio::initialize() {
+    const WavFormat &format = input->format;
+    std::uint64_t frames = format.dataSize / format.blockAlign;
+    this->setSampleRate(static_cast<float>(format.sampleRate));
+    this->setSampleSize(static_cast<std::size_t>(std::min<std::uint64_t>(frames, unknownLength)));
+    this->setDuration(static_cast<double>(this->getSampleSize()) / this->getSampleRate());
+    this->setChannels(format.channels);
+}
+
+sample StreamAudio::operator[](std::size_t index) const {
+    std::vector<sample> frame(this->getChannels());
+    std::vector<sample *> planes(this->getChannels());
+    for (unsigned c = 0; c < this->getChannels(); ++c) {
+        planes[c] = &frame[c];
+    }
+    this->render(index, 1, planes.data());
+    return frame[0];
+}
+
+sample &StreamAudio::operator[](std::size_t /*index*/) {
+    throw std::logic_error("StreamAudio does not support sample modification.");
+}
+
+void StreamAudio::render(std::size_t start, std::size_t count, sample *const *out) const {
+    std::lock_guard<std::mutex> guard(input->lock);
+    const WavFormat &format = input->format;
+    if (start < input->framesRead) {
+        throw std::logic_error("StreamAudio can only be rendered forward: requested sample " + std::to_string(start) +
+                               " after reading " + std::to_string(input->framesRead));
+    }
+    std::size_t framesPerRead = std::max<std::size_t>(1, readBlockBytes / format.blockAlign);
+    std::size_t end = std::min(start + count, this->getSampleSize());
+
+    // Reads up to `frames` frames into the scratch buffer, returning how many complete frames arrived
+    auto readFrames = [&](std::size_t frames) -> std::size_t {
+        std::size_t byteCount = frames * format.blockAlign;
+        input->bytes.resize(std::max(input->bytes.size(), byteCount));
+        input->in.read(reinterpret_cast<char *>(input->bytes.data()), static_cast<std::streamsize>(byteCount));
+        std::size_t got = static_cast<std::size_t>(input->in.gcount()) / format.blockAlign;
+        if (got < frames) {
+            input->ended = true; // A trailing partial frame is dropped
+        }
+        input->framesRead += got;
+        return got;
+    };
+
+    // Skipped ranges are read and discarded
+    while (!input->ended && input->framesRead < std::min<std::size_t>(start, end)) {
+        readFrames(std::min<std::size_t>(framesPerRead, start - input->framesRead));
+    }
+
+    std::size_t available = 0;
+    while (!input->ended && input->framesRead == start + available && start + available < end) {
+        std::size_t got = readFrames(std::min(framesPerRead, end - start - available));
+        std::vector<sample *> block(format.channels);
+        for (unsigned c = 0; c < format.channels; ++c) {
+            block[c] = out[c] + available;
+        }
+        decodeWavFrames(format, input->bytes.data(), got, block.data());
+        available += got;
+    }
+    if (input->framesRead >= this->getSampleSize()) {
+        input->ended = true;
+    }
+    for (unsigned c = 0; c < this->getChannels(); ++c) {
+        std::fill(out[c] + available, out[c] + count, 0.0);
+    }
+}
+
+AudioStats StreamAudio::analyze() const {
+    throw std::logic_error("StreamAudio cannot be analyzed: the stream can only be read once.");
+}
+
+bool StreamAudio::isRandomAccess() const {
+    return false;
+}
+
+bool StreamAudio::atEnd() const {
+    std::lock_guard<std::mutex> guard(input->lock);
+    return input->ended;
+}
+
+std::uint64_t StreamAudio::getFramesRead() const {
+    std::lock_guard<std::mutex> guard(input->lock);
+    return input->framesRead;
+}
+
+bool StreamAudio::trimToEnd(std::uint64_t start, std::size_t &count) const {
+    std::lock_guard<std::mutex> guard(input->lock);
+    if (!input->ended) {
+        return false;
+    }
+    // Only the part of the block the input actually delivered is real audio
+    std::uint64_t delivered = input->framesRead;
+    count = (delivered > start) ? static_cast<std::size_t>(std::min<std::uint64_t>(count, delivered - start)) : 0;
+    return true;
+}
+
+StreamAudio *StreamAudio::clone() const {
+    return new StreamAudio(*this);
+}
+
+std::ostream &StreamAudio::printToStream(std::ostream &out) const {
+    out << "StreamAudio: " << this->getChannels() << " channels @ " << this->getSampleRate() << "Hz, "
+        << this->getFramesRead() << " samples read" << (this->atEnd() ? " (ended)" : "") << "\n";
+    return out;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file StreamAudio.hpp
+ * @brief Defines the StreamAudio class, a sequential audio source read from a byte stream such as stdin.
+ */
+
+#ifndef DAW_STREAMAUDIO_HPP
+#define DAW_STREAMAUDIO_HPP
+
+#include "Audio.hpp"
+#include "WavFormat.hpp"
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Audio decoded from a WAV or raw PCM byte stream as it is rendered.
+ *
+ * The stream is read strictly forward, one rendered block at a time, so a pipe of any
+ * length is processed in constant memory. `render()` must be called with non-decreasing
+ * start indices (skipped ranges are read and discarded); `isRandomAccess()` returns false
+ * so that consumers know not to split the audio into parallel chunks. Clones share the stream.
+ *
+ * When the length is unknown (raw PCM, or a WAV header written by a streaming encoder),
+ * `getSampleSize()` is only an upper bound and `atEnd()`/`getFramesRead()` tell where the
+ * input actually stopped; everything past the end renders as silence.
+ */
+class StreamAudio : public Audio {
+private:
+    /**
+     * @brief Read state shared by every clone of one stream.
+     */
+    struct Input {
+        std::istream &in;                 ///< The stream being read.
+        WavFormat format;                 ///< The format of the sample data.
+        std::uint64_t framesRead = 0;     ///< Frames consumed from the stream so far.
+        bool ended = false;               ///< Whether the stream has run out of data.
+        std::vector<unsigned char> bytes; ///< Scratch for raw frames of one block.
+        std::mutex lock;                  ///< Serializes reads from clones on different threads.
+
+        /**
+         * @brief Wraps a stream whose sample data starts at the current position.
+         * @param in The input stream.
+         * @param format The format of the sample data.
+         */
+        Input(std::istream &in, const WavFormat &format);
+    };
+
+    std::shared_ptr<Input> input; ///< The shared read state.
+
+    /**
+     * @brief Sets the audio properties from the format.
+     */
+    void initialize();
+
+public:
+    /// @brief The sample size reported when the stream does not declare its length.
+    static constexpr std::size_t unknownLength = static_cast<std::size_t>(1) << 48;
+
+    /**
+     * @brief Reads a WAV header from the stream and streams the data chunk after it.
+     *
+     * A declared data size of 0 or 0xFFFFFFFF, as left by streaming encoders, is taken as
+     * "read until the end of the stream".
+     * @param in The input stream, opened in binary mode and positioned at the RIFF header.
+     * @throws std::runtime_error if the header is invalid or the format is unsupported.
+     */
+    explicit StreamAudio(std::istream &in);
+
+    /**
+     * @brief Streams headerless interleaved PCM or float samples until the end of the stream.
+     * @param in The input stream, opened in binary mode.
+     * @param encoding PCM or float samples.
+     * @param channels The number of interleaved channels.
+     * @param sampleRate The sample rate in Hz.
+     * @param bitsPerSample 8, 16, 24 or 32 for PCM; 32 or 64 for float.
+     * @throws std::invalid_argument if the format is not supported.
+     */
+    StreamAudio(std::istream &in, WavEncoding encoding, unsigned channels, unsigned sampleRate,
+                unsigned bitsPerSample);
+
+    /**
+     * @brief Reads the sample of the first channel at the given index.
+     * @param index The index of the sample; must not be before the read position.
+     * @return The sample value, or 0.0 past the end of the stream.
+     * @throws std::logic_error if the index is before the read position.
+     */
+    sample operator[](std::size_t index) const override;
+
+    /**
+     * @brief Accesses a sample (non-const version).
+     * @throws std::logic_error as streamed audio is read-only.
+     * @param index The sample index (unused).
+     * @return A reference to a sample (never actually returns due to exception).
+     */
+    sample &operator[](std::size_t index) override;
+
+    /**
+     * @brief Reads and decodes the next block of every channel from the stream.
+     * @param start The index of the first sample to render; must not be before the read position.
+     * @param count The number of samples to render per channel.
+     * @param out One destination plane per channel; samples past the end of the stream are written as silence.
+     * @throws std::logic_error if `start` is before the read position.
+     */
+    void render(std::size_t start, std::size_t count, sample *const *out) const override;
+
+    /**
+     * @brief Statistics need a second pass over the data, which a stream cannot provide.
+     * @throws std::logic_error always.
+     * @return Never returns.
+     */
+    AudioStats analyze() const override;
+
+    /**
+     * @brief Checks whether samples can be rendered in any order.
+     * @return False, as the stream can only be read forward.
+     */
+    bool isRandomAccess() const override;
+
+    /**
+     * @brief Checks whether the stream has run out of data.
+     * @return True once a render has reached the end of the input.
+     */
+    bool atEnd() const;
+
+    /**
+     * @brief Gets the number of frames read from the stream so far.
+     * @return The number of frames.
+     */
+    std::uint64_t getFramesRead() const;
+
+    /**
+     * @brief Trims a block just rendered from the stream to the frames the input actually delivered.
+     *
+     * Writers of audio of unknown length call this after each block and stop once it returns true.
+     * @param start The index of the first frame of the block.
+     * @param count The frames in the block; reduced to the frames before the end of the input.
+     * @return True if the input has ended, so the block is the last one.
+     */
+    bool trimToEnd(std::uint64_t start, std::size_t &count) const;
+
+    /**
+     * @brief Clones the StreamAudio object.
+     * @return A pointer to a new StreamAudio reading from the same stream.
+     */
+    StreamAudio *clone() const override;
+
+    /**
+     * @brief Prints a summary of the stream to an output stream.
+     * @param out The output stream.
+     * @return A reference to the output stream.
+     */
+    std::ostream &printToStream(std::ostream &out) const override;
+};
+
+#endif //DAW_STREAMAUDIO_HPP
@@ -0,0 +1,50 @@
+#include "StreamRender.hpp"
+#include "SampleBuffer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+std::uint64_t streamRender(const Audio &audio, WavWriter &writer, const StreamAudio *input) {
+    if (audio.getChannels() != writer.getChannels()) {
+        throw std::invalid_argument("Stream render channel mismatch: audio has " +
+                                    std::to_string(audio.getChannels()) + ", writer expects " +
+                                    std::to_string(writer.getChannels()));
+    }
+    PlanarBlock block(audio.getChannels());
+    std::uint64_t written = 0;
+    for (std::size_t pos = 0; pos < audio.getSampleSize(); pos += Audio::blockSize) {
+        std::size_t count = std::min(Audio::blockSize, audio.getSampleSize() - pos);
+        AudioRegion region = audio.describeRegion(pos, count);
+        if (region.isSilent() && !input) {
+            writer.writeSilence(count); // Gaps cost no rendering
+            written += count;
+            continue;
+        }
+        if (region.constant) {
+            for (unsigned c = 0; c < block.channels(); ++c) {
+                std::fill(block[c], block[c] + count, region.value);
+            }
+        } else {
+            audio.render(pos, count, block.planes());
+        }
+        bool last = input && input->trimToEnd(pos, count);
+        writer.write(block.planes(), count);
+        written += count;
+        if (last) {
+            break;
+        }
+    }
+    return written;
+}
+
+std::uint64_t streamToWav(const Audio &audio, std::ostream &out, WavEncoding encoding, unsigned bitsPerSample,
+                          WavDither dither, const StreamAudio *input) {
+    std::uint64_t expectedFrames = (input && input->getSampleSize() == StreamAudio::unknownLength)
+                                   ? 0 : audio.getSampleSize();
+    WavWriter writer(out, audio.getChannels(), static_cast<unsigned>(std::lround(audio.getSampleRate())), encoding,
+                     bitsPerSample, dither, expectedFrames);
+    std::uint64_t written = streamRender(audio, writer, input);
+    writer.finish();
+    return written;
+}
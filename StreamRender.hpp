@@ -0,0 +1,48 @@
+/**
+ * @file StreamRender.hpp
+ * @brief Declares the streaming render pipeline that writes any audio graph to a WAV stream in bounded memory.
+ */
+
+#ifndef DAW_STREAMRENDER_HPP
+#define DAW_STREAMRENDER_HPP
+
+#include "Audio.hpp"
+#include "StreamAudio.hpp"
+#include "WavWriter.hpp"
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @brief Pulls an audio graph block by block into a WAV writer.
+ *
+ * Only one block of planes is ever held, so peak memory does not depend on the length
+ * of the audio. Blocks are rendered in order, so sequential sources are supported.
+ * Blocks that `describeRegion()` reports as silent are written without rendering.
+ * @param audio The audio to render. Must have the writer's channel count.
+ * @param writer The destination writer.
+ * @param input The sequential input feeding `audio`, if its length is unknown: rendering stops
+ *              where that input runs out instead of at `audio.getSampleSize()`. The graph must
+ *              be sample-aligned with it, as every effect is.
+ * @return The number of frames written.
+ * @throws std::invalid_argument if the channel counts differ.
+ */
+std::uint64_t streamRender(const Audio &audio, WavWriter &writer, const StreamAudio *input = nullptr);
+
+/**
+ * @brief Renders an audio graph straight into a WAV stream and finishes the file.
+ *
+ * The header sizes are patched if the stream is seekable; otherwise they are taken from the
+ * audio's length, unless `input` is given and the length is therefore not known up front.
+ * @param audio The audio to render.
+ * @param out The destination stream, opened in binary mode.
+ * @param encoding PCM or float output.
+ * @param bitsPerSample 16, 24 or 32 for PCM; 32 for float.
+ * @param dither The rounding mode for PCM output.
+ * @param input The sequential input of unknown length feeding `audio`, if any.
+ * @return The number of frames written.
+ */
+std::uint64_t streamToWav(const Audio &audio, std::ostream &out, WavEncoding encoding = WavEncoding::PCM,
+                          unsigned bitsPerSample = 16, WavDither dither = WavDither::None,
+                          const StreamAudio *input = nullptr);
+
+#endif //DAW_STREAMRENDER_HPP
@@ -0,0 +1,147 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+
+/// The pool and deque index of the worker running on this thread, if any
+static thread_local const ThreadPool *currentPool = nullptr;
+static thread_local std::size_t currentIndex = 0;
+
+ThreadPool::ThreadPool(std::size_t threadCount) : queued(0), nextQueue(0), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+ThreadPool &ThreadPool::getInstance() {
+    static ThreadPool pool([]() -> std::size_t {
+        const char *env = std::getenv("DAW_THREADS");
+        return env ? static_cast<std::size_t>(std::strtoul(env, nullptr, 10)) : 0;
+    }());
+    return pool;
+}
+
+std::size_t ThreadPool::getThreadCount() const {
+    return workers.size();
+}
+
+bool ThreadPool::takeTask(std::size_t index, std::function<void()> &task) {
+    {
+        WorkerQueue &own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+    for (std::size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkerQueue &victim = *queues[(index + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(std::size_t index) {
+    currentPool = this;
+    currentIndex = index;
+    while (true) {
+        std::function<void()> task;
+        if (takeTask(index, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        available.wait(lock, [this]() { return stopping || queued.load() > 0; });
+        if (stopping && queued.load() == 0) {
+            return; // Stopping and nothing left to do
+        }
+    }
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    std::size_t index = (currentPool == this) ? currentIndex : nextQueue.fetch_add(1) % queues.size();
+    {
+        WorkerQueue &queue = *queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+        queued.fetch_add(1);
+    }
+    // Taking the lock orders the count update before any sleeping worker re-checks it
+    { std::lock_guard<std::mutex> lock(mutex); }
+    available.notify_one();
+}
+
+void ThreadPool::parallelFor(std::size_t begin, std::size_t end, std::size_t grain,
+                             const std::function<void(std::size_t, std::size_t)> &body) {
+    if (end <= begin) return;
+    grain = std::max<std::size_t>(grain, 1);
+    std::size_t chunks = (end - begin + grain - 1) / grain;
+    if (chunks == 1 || workers.empty()) {
+        body(begin, end);
+        return;
+    }
+
+    // Shared with the helper tasks, which may still be queued after this call returns
+    struct State {
+        std::atomic<std::size_t> next{0};
+        std::size_t done = 0;
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+
+    auto run = [state, begin, end, grain, chunks, body]() {
+        std::size_t chunk;
+        while ((chunk = state->next.fetch_add(1)) < chunks) {
+            std::size_t chunkBegin = begin + chunk * grain;
+            std::size_t chunkEnd = std::min(end, chunkBegin + grain);
+            try {
+                body(chunkBegin, chunkEnd);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->error) state->error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (++state->done == chunks) state->finished.notify_all();
+        }
+    };
+
+    std::size_t helpers = std::min(workers.size(), chunks - 1);
+    for (std::size_t i = 0; i < helpers; ++i) {
+        enqueue(run);
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&]() { return state->done == chunks; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
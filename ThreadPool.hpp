@@ -0,0 +1,143 @@
+/**
+ * @file ThreadPool.hpp
+ * @brief Defines the ThreadPool class used to spread audio work across cores.
+ */
+
+#ifndef DAW_THREADPOOL_HPP
+#define DAW_THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A fixed-size, work-stealing pool of worker threads.
+ *
+ * Every worker owns a deque of tasks. Tasks queued from a worker go to the back of its own deque,
+ * and the worker takes its newest task first, which keeps nested work cache-warm. Tasks queued
+ * from other threads are dealt round-robin across the deques. A worker whose deque is empty
+ * steals the oldest task from the others before it sleeps.
+ *
+ * Tasks are queued with `submit()`. `parallelFor()` splits an index range into chunks that the
+ * workers and the calling thread process together; because the caller always helps, it is safe
+ * to call `parallelFor()` from inside a pool task.
+ */
+class ThreadPool {
+private:
+    /**
+     * @brief The task deque owned by one worker.
+     */
+    struct WorkerQueue {
+        std::deque<std::function<void()>> tasks; ///< Tasks, newest at the back.
+        std::mutex mutex;                        ///< Guards `tasks`.
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues; ///< One deque per worker.
+    std::vector<std::thread> workers;                 ///< The worker threads.
+    std::atomic<std::size_t> queued;                  ///< The number of tasks in all deques.
+    std::atomic<std::size_t> nextQueue;               ///< The deque for the next task queued from outside.
+    std::mutex mutex;                                 ///< Guards sleeping and `stopping`.
+    std::condition_variable available;                ///< Signalled when a task is queued or the pool stops.
+    bool stopping;                                    ///< Set when the pool is being destroyed.
+
+    /**
+     * @brief The loop run by every worker thread: runs and steals tasks until the pool stops.
+     * @param index The index of the worker.
+     */
+    void workerLoop(std::size_t index);
+
+    /**
+     * @brief Takes a task for a worker: its own newest task, or else the oldest task of another worker.
+     * @param index The index of the worker.
+     * @param task Set to the task taken.
+     * @return True if a task was taken.
+     */
+    bool takeTask(std::size_t index, std::function<void()> &task);
+
+    /**
+     * @brief Queues a type-erased task.
+     * @param task The task to run on a worker thread.
+     */
+    void enqueue(std::function<void()> task);
+
+public:
+    /**
+     * @brief Constructs a thread pool.
+     * @param threadCount The number of worker threads; 0 uses the number of hardware threads.
+     */
+    explicit ThreadPool(std::size_t threadCount = 0);
+
+    /**
+     * @brief Destructor. Finishes the queued tasks and joins all workers.
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief Deleted copy constructor to prevent copying.
+     */
+    ThreadPool(const ThreadPool &other) = delete;
+
+    /**
+     * @brief Deleted assignment operator to prevent assignment.
+     */
+    ThreadPool &operator=(const ThreadPool &other) = delete;
+
+    /**
+     * @brief Gets the process-wide shared pool.
+     *
+     * Its size is the number of hardware threads, or the value of the `DAW_THREADS` environment variable.
+     * @return A reference to the shared ThreadPool instance.
+     */
+    static ThreadPool &getInstance();
+
+    /**
+     * @brief Gets the number of worker threads.
+     * @return The number of worker threads.
+     */
+    std::size_t getThreadCount() const;
+
+    /**
+     * @brief Queues a task and returns a future for its result.
+     * @tparam Function A callable taking no arguments.
+     * @param function The task to run.
+     * @return A future that receives the task's result or exception.
+     */
+    template<typename Function>
+    auto submit(Function function) -> std::future<decltype(function())>;
+
+    /**
+     * @brief Runs `body` over [begin, end) split into chunks of `grain` indices, in parallel.
+     *
+     * The calling thread takes part and the call returns once every chunk has finished.
+     * The first exception thrown by `body` is rethrown to the caller.
+     * @param begin The first index.
+     * @param end One past the last index.
+     * @param grain The number of indices per chunk.
+     * @param body Called as `body(chunkBegin, chunkEnd)` for every chunk.
+     */
+    void parallelFor(std::size_t begin, std::size_t end, std::size_t grain,
+                     const std::function<void(std::size_t, std::size_t)> &body);
+};
+
+/**
+ * @brief Implementation of submit.
+ * @tparam Function A callable taking no arguments.
+ * @param function The task to run.
+ * @return A future that receives the task's result or exception.
+ */
+template<typename Function>
+auto ThreadPool::submit(Function function) -> std::future<decltype(function())> {
+    auto task = std::make_shared<std::packaged_task<decltype(function())()>>(std::move(function));
+    std::future<decltype(function())> result = task->get_future();
+    enqueue([task]() { (*task)(); });
+    return result;
+}
+
+#endif //DAW_THREADPOOL_HPP
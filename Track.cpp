@@ -1 +1,218 @@
 #include "Track.hpp"
+#include "Kernels.hpp"
+#include "SampleBuffer.hpp"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+Track::Track(float sampleRate) : Audio() {
+    this->sampleRate = sampleRate;
+}
+
+std::size_t Track::build(std::size_t lo, std::size_t hi) {
+    if (lo >= hi) {
+        return 0;
+    }
+    std::size_t mid = lo + (hi - lo) / 2;
+    std::size_t furthest = std::max(this->clips[mid].end(), std::max(this->build(lo, mid), this->build(mid + 1, hi)));
+    this->maxEnds[mid] = furthest;
+    return furthest;
+}
+
+void Track::reindex() {
+    this->maxEnds.assign(this->clips.size(), 0);
+    this->sampleSize = this->build(0, this->clips.size());
+    this->channels = 1;
+    for (const TrackClip &clip : this->clips) {
+        this->channels = std::max(this->channels, clip.audio->getChannels());
+    }
+    this->duration = static_cast<double>(this->sampleSize) / this->sampleRate;
+}
+
+void Track::collect(std::size_t lo, std::size_t hi, std::size_t start, std::size_t end,
+                    std::vector<std::size_t> &found) const {
+    if (lo >= hi) {
+        return;
+    }
+    std::size_t mid = lo + (hi - lo) / 2;
+    if (this->maxEnds[mid] <= start) {
+        return; // Everything in this subtree has ended before the range
+    }
+    this->collect(lo, mid, start, end, found);
+    if (this->clips[mid].position >= end) {
+        return; // This clip and everything after it start after the range
+    }
+    if (this->clips[mid].end() > start) {
+        found.push_back(mid);
+    }
+    this->collect(mid + 1, hi, start, end, found);
+}
+
+// Rejects clips that cannot be placed on a track of the given rate
+static void checkClip(const Audio *audio, float sampleRate) {
+    if (!audio) {
+        throw std::invalid_argument("Track clip is null");
+    }
+    if (audio->getSampleRate() != sampleRate) {
+        throw std::invalid_argument("Track clip sample rate " + std::to_string(audio->getSampleRate())
+                                    + " does not match the track rate " + std::to_string(sampleRate));
+    }
+}
+
+std::size_t Track::addClip(std::shared_ptr<const Audio> audio, std::size_t position, double gain) {
+    checkClip(audio.get(), this->sampleRate);
+    auto at = std::upper_bound(this->clips.begin(), this->clips.end(), position,
+                               [](std::size_t value, const TrackClip &clip) { return value < clip.position; });
+    std::size_t index = static_cast<std::size_t>(at - this->clips.begin());
+    this->clips.insert(at, TrackClip{std::move(audio), position, static_cast<sample>(gain)});
+    this->reindex();
+    return index;
+}
+
+void Track::addClips(std::vector<TrackClip> added) {
+    for (const TrackClip &clip : added) {
+        checkClip(clip.audio.get(), this->sampleRate);
+    }
+    std::size_t existing = this->clips.size();
+    this->clips.insert(this->clips.end(), std::make_move_iterator(added.begin()), std::make_move_iterator(added.end()));
+    // Stable, so clips at the same position keep the order they were added in, as with addClip()
+    auto byPosition = [](const TrackClip &a, const TrackClip &b) { return a.position < b.position; };
+    std::stable_sort(this->clips.begin() + static_cast<std::ptrdiff_t>(existing), this->clips.end(), byPosition);
+    std::inplace_merge(this->clips.begin(), this->clips.begin() + static_cast<std::ptrdiff_t>(existing),
+                       this->clips.end(), byPosition);
+    this->reindex();
+}
+
+void Track::removeClip(std::size_t index) {
+    if (index >= this->clips.size()) {
+        throw std::out_of_range("Track clip index " + std::to_string(index) + " is out of range");
+    }
+    this->clips.erase(this->clips.begin() + static_cast<std::ptrdiff_t>(index));
+    this->reindex();
+}
+
+const TrackClip &Track::getClip(std::size_t index) const {
+    if (index >= this->clips.size()) {
+        throw std::out_of_range("Track clip index " + std::to_string(index) + " is out of range");
+    }
+    return this->clips[index];
+}
+
+std::size_t Track::getClipCount() const {
+    return this->clips.size();
+}
+
+void Track::findClips(std::size_t start, std::size_t end, std::vector<std::size_t> &found) const {
+    found.clear();
+    if (start < end) {
+        this->collect(0, this->clips.size(), start, end, found);
+    }
+}
+
+sample Track::operator[](std::size_t i) const {
+    std::vector<std::size_t> found;
+    this->findClips(i, i + 1, found);
+    sample value = 0;
+    for (std::size_t index : found) {
+        const TrackClip &clip = this->clips[index];
+        value += (*clip.audio)[i - clip.position] * clip.gain;
+    }
+    return value;
+}
+
+sample &Track::operator[](std::size_t /*i*/) {
+    throw std::logic_error("Track does not support sample modification.");
+}
+
+void Track::render(std::size_t start, std::size_t count, sample *const *out) const {
+    unsigned channels = this->channels;
+    for (unsigned c = 0; c < channels; ++c) {
+        std::fill(out[c], out[c] + count, 0.0);
+    }
+    std::size_t available = (start < this->sampleSize) ? std::min(count, this->sampleSize - start) : 0;
+    if (available == 0) {
+        return;
+    }
+
+    const KernelSet &kernels = activeKernels();
+    PlanarBlock scratch(channels, std::min(available, Audio::blockSize));
+    std::vector<std::size_t> active;
+    for (std::size_t pos = 0; pos < available; pos += Audio::blockSize) {
+        std::size_t blockStart = start + pos;
+        std::size_t blockEnd = blockStart + std::min(Audio::blockSize, available - pos);
+        this->findClips(blockStart, blockEnd, active);
+        for (std::size_t index : active) {
+            const TrackClip &clip = this->clips[index];
+            std::size_t from = std::max(blockStart, clip.position);
+            std::size_t length = std::min(blockEnd, clip.end()) - from;
+            std::size_t clipStart = from - clip.position;
+            AudioRegion region = clip.audio->describeRegion(clipStart, length);
+            if (region.isSilent()) {
+                continue;
+            }
+            if (region.constant) {
+                std::fill(scratch[0], scratch[0] + length, region.value);
+            } else {
+                clip.audio->render(clipStart, length, scratch.planes());
+            }
+            // A constant region has one value on every channel, so its first plane stands for all of them
+            bool shared = region.constant || clip.audio->getChannels() == 1;
+            unsigned fed = clip.audio->getChannels() == 1 ? channels : clip.audio->getChannels();
+            for (unsigned c = 0; c < fed; ++c) {
+                kernels.mulAdd(scratch[shared ? 0 : c], length, clip.gain, out[c] + (from - start));
+            }
+        }
+    }
+}
+
+AudioRegion Track::describeRegion(std::size_t start, std::size_t count) const {
+    if (start >= this->sampleSize) {
+        return Audio::describeRegion(start, count);
+    }
+    std::size_t end = start + std::min(count, this->sampleSize - start);
+    std::vector<std::size_t> found;
+    this->findClips(start, end, found);
+
+    AudioRegion region;
+    region.constant = true; // Gaps are silent
+    if (found.size() == 1) {
+        const TrackClip &clip = this->clips[found.front()];
+        unsigned clipChannels = clip.audio->getChannels();
+        bool fillsAll = clipChannels == 1 || clipChannels == this->channels;
+        if (fillsAll && clip.position <= start && clip.end() >= start + count) {
+            AudioRegion inner = clip.audio->describeRegion(start - clip.position, count);
+            if (inner.constant && inner.value != 0) {
+                inner.value *= clip.gain;
+            }
+            return inner;
+        }
+    }
+    for (std::size_t index : found) {
+        const TrackClip &clip = this->clips[index];
+        std::size_t from = std::max(start, clip.position);
+        if (!clip.audio->describeRegion(from - clip.position, std::min(end, clip.end()) - from).isSilent()) {
+            return AudioRegion();
+        }
+    }
+    return region;
+}
+
+bool Track::isRandomAccess() const {
+    return std::all_of(this->clips.begin(), this->clips.end(),
+                       [](const TrackClip &clip) { return clip.audio->isRandomAccess(); });
+}
+
+Track *Track::clone() const {
+    return new Track(*this);
+}
+
+std::ostream &Track::printToStream(std::ostream &out) const {
+    out << "Track: " << this->clips.size() << " clips, " << this->sampleSize << " samples x "
+        << this->channels << " channels @ " << this->sampleRate << "Hz\n";
+    for (const TrackClip &clip : this->clips) {
+        out << "  @" << clip.position << " x" << clip.gain << ": ";
+        clip.audio->printToStream(out);
+    }
+    return out;
+}
@@ -1,65 +1,185 @@
 /**
  * @file Track.hpp
- * @brief Defines the Track class for managing a sequence of audio segments.
+ * @brief Defines the Track class for placing audio clips on a timeline.
  */
 
 #ifndef DAW_TRACK_HPP
 #define DAW_TRACK_HPP
 
 #include "Audio.hpp" // Defines the Audio base class
+#include <memory>
+#include <vector>
+
+/**
+ * @brief An audio clip placed on a track.
+ */
+struct TrackClip {
+    std::shared_ptr<const Audio> audio; ///< The clip audio.
+    std::size_t position = 0;           ///< The sample offset of the clip on the track.
+    sample gain = 1;                    ///< The gain applied to the clip.
+
+    /**
+     * @brief Gets the end of the clip on the track.
+     * @return One past the last sample offset covered by the clip.
+     */
+    std::size_t end() const {
+        return this->position + this->audio->getSampleSize();
+    }
+};
 
 /**
  * @brief Represents a single track within an audio project.
  *
- * A track consists of a sequence of `Audio` objects (clips or segments).
- * It might also have track-specific properties like volume, pan, effects, etc.
+ * A track is itself an `Audio`: the sum of its clips, each placed at a sample offset, with
+ * silence in the gaps. Mono clips feed every channel; other clips feed the channels they have.
+ *
+ * Clips are kept sorted by position and indexed by an implicit interval tree: a balanced tree laid
+ * over the sorted array, where every node records the furthest end in its subtree. Finding the
+ * clips that overlap a range skips every subtree that ends before it, so it takes O(log n + k)
+ * for the usual tracks whose clips do not nest, and never more than O(k log n). Rendering looks
+ * up the active clips once per block, so it only touches clips that are actually playing.
+ * The index is rebuilt on every edit, so many clips are placed together with `addClips()`.
  *
- * @note TODO: Consider whether `Track` itself should also inherit from `Audio`.
- *       This would allow tracks to be treated as composite audio objects,
- *       which could be useful for sub-mixing or hierarchical project structures.
- * @note TODO: Ensure that a `Track` cannot contain another `Track` directly
- *       if the design intends a flat list of audio clips per track. If hierarchical
- *       tracks are desired, this needs careful design.
+ * @note A track may contain another track as a clip, which gives sub-mixes.
  */
-class Track {
+class Track : public Audio {
 private:
-    std::vector<Audio *> audio; ///< A collection of pointers to Audio objects forming the track.
-    ///< Manages ownership of these Audio objects.
-    size_t audioSize;           ///< The number of Audio objects currently in the track.
-    ///< This might be redundant if `audio.size()` is always used.
+    std::vector<TrackClip> clips;      ///< The clips, sorted by position.
+    std::vector<std::size_t> maxEnds;  ///< The furthest clip end in the subtree rooted at each index.
 
-    double frequency;           ///< The sample rate (frequency in Hz) for this track.
-    ///< This could influence how audio data is processed or mixed within the track.
+    /**
+     * @brief Rebuilds the interval index and the track length after a change.
+     */
+    void reindex();
+
+    /**
+     * @brief Builds the index of a subtree.
+     * @param lo The first clip of the subtree.
+     * @param hi One past the last clip of the subtree.
+     * @return The furthest end in the subtree, or 0 if it is empty.
+     */
+    std::size_t build(std::size_t lo, std::size_t hi);
+
+    /**
+     * @brief Collects the clips of a subtree that overlap a range, in position order.
+     * @param lo The first clip of the subtree.
+     * @param hi One past the last clip of the subtree.
+     * @param start The first sample of the range.
+     * @param end One past the last sample of the range.
+     * @param found The vector to append clip indices to.
+     */
+    void collect(std::size_t lo, std::size_t hi, std::size_t start, std::size_t end,
+                 std::vector<std::size_t> &found) const;
 
 public:
     /**
-     * @brief Applies one or more audio effects to the track or its constituent audio clips.
+     * @brief Constructs an empty track.
+     * @param sampleRate The sample rate of the track; clips must match it.
+     */
+    explicit Track(float sampleRate = 44100.0f);
+
+    /**
+     * @brief Places a clip on the track.
+     *
+     * The whole track is indexed again, which takes O(n), so building a track clip by clip takes
+     * O(n²). Loaders and other code placing many clips must use `addClips()` instead.
+     * @param audio The clip audio. Must not be null and must have the track's sample rate.
+     * @param position The sample offset of the clip.
+     * @param gain The gain applied to the clip.
+     * @return The index of the clip, which stays valid until clips are added or removed.
+     * @throws std::invalid_argument if the clip is null or its sample rate differs.
+     */
+    std::size_t addClip(std::shared_ptr<const Audio> audio, std::size_t position, double gain = 1.0);
+
+    /**
+     * @brief Places many clips on the track at once, indexing them only once.
      *
-     * The specific effects and how they are applied (e.g., to individual clips,
-     * the entire track output, or as insert/send effects) would be defined
-     * in the implementation. This might involve iterating through audio clips
-     * and wrapping them with Effect objects, or applying effects during a mixing process.
-     * @note The implementation details (which effects, how they are configured, etc.)
-     *       are not specified in this header.
-     */
-//    void applyEffect();
-
-    // Potential future methods to document if added:
-    // Track(double freq);
-    // ~Track(); // Important for managing memory of Audio pointers in `audio` vector.
-    // void addAudioClip(Audio* clip, size_t position);
-    // void removeAudioClip(size_t index);
-    // Audio* getAudioClip(size_t index) const;
-    // size_t getAudioClipCount() const;
-    // void setVolume(double volume);
-    // double getVolume() const;
-    // void setPan(double pan);
-    // double getPan() const;
-    // bool isMuted() const;
-    // void setMuted(bool muted);
-    // bool isSoloed() const;
-    // void setSoloed(bool soloed);
-    // double getDuration() const; // Would need to calculate total duration from clips
+     * This is the way to fill a track: it takes O((n + m) log m) for m clips added to n, where
+     * adding them one at a time with `addClip()` would take O(m (n + m)).
+     * @param added The clips to place. Each must have audio at the track's sample rate.
+     * @throws std::invalid_argument if a clip is null or its sample rate differs; no clip is added then.
+     */
+    void addClips(std::vector<TrackClip> added);
+
+    /**
+     * @brief Removes a clip from the track.
+     * @param index The index of the clip.
+     * @throws std::out_of_range if the index is invalid.
+     */
+    void removeClip(std::size_t index);
+
+    /**
+     * @brief Gets a clip.
+     * @param index The index of the clip, in position order.
+     * @return The clip.
+     * @throws std::out_of_range if the index is invalid.
+     */
+    const TrackClip &getClip(std::size_t index) const;
+
+    /**
+     * @brief Gets the number of clips on the track.
+     * @return The number of clips.
+     */
+    std::size_t getClipCount() const;
+
+    /**
+     * @brief Finds the clips that overlap a range.
+     * @param start The first sample of the range.
+     * @param end One past the last sample of the range.
+     * @param found Cleared, then filled with the indices of the overlapping clips in position order.
+     */
+    void findClips(std::size_t start, std::size_t end, std::vector<std::size_t> &found) const;
+
+    /**
+     * @brief Computes a sample of the first channel.
+     * @param i The sample index.
+     * @return The sum of the clips playing at index `i`.
+     */
+    sample operator[](std::size_t i) const override;
+
+    /**
+     * @brief Accesses a sample (non-const version).
+     * @throws std::logic_error as clips are edited through `addClip()` and `removeClip()`.
+     * @param i The sample index (unused).
+     * @return A reference to a sample (never actually returns due to exception).
+     */
+    sample &operator[](std::size_t i) override;
+
+    /**
+     * @brief Renders a block of every channel from the clips active in it.
+     * @param start The index of the first sample to render.
+     * @param count The number of samples to render per channel.
+     * @param out One destination plane per channel; gaps are written as silence.
+     */
+    void render(std::size_t start, std::size_t count, sample *const *out) const override;
+
+    /**
+     * @brief Describes a range of the track from the clips that overlap it.
+     * @param start The index of the first sample of the range.
+     * @param count The number of samples in the range.
+     * @return A silent region for gaps and silent clips, the clip's own description when one clip
+     *         covers the whole range, otherwise an unknown region.
+     */
+    AudioRegion describeRegion(std::size_t start, std::size_t count) const override;
+
+    /**
+     * @brief Checks whether every clip can be rendered in any order.
+     * @return True if all clips are random access.
+     */
+    bool isRandomAccess() const override;
+
+    /**
+     * @brief Clones the Track object.
+     * @return A pointer to a new Track sharing the same clips.
+     */
+    Track *clone() const override;
+
+    /**
+     * @brief Prints a summary of the track to an output stream.
+     * @param out The output stream.
+     * @return A reference to the output stream.
+     */
+    std::ostream &printToStream(std::ostream &out) const override;
 };
 
 #endif //DAW_TRACK_HPP
@@ -0,0 +1,152 @@
+#include "TxtCodec.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+/// Bytes of text per parallel parse chunk
+static constexpr std::size_t parseChunkBytes = 1 << 20;
+
+/// Frames per parallel format chunk
+static constexpr std::size_t formatChunkFrames = 1 << 16;
+
+/// Longest shortest-round-trip representation of a double, with room to spare
+static constexpr std::size_t maxNumberChars = 32;
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static const char *skipSpace(const char *cursor, const char *end) {
+    while (cursor < end && isSpace(*cursor)) {
+        ++cursor;
+    }
+    return cursor;
+}
+
+// Parses one number ending at whitespace or the end of the text; `>>` also accepted a leading '+'
+template<typename T>
+static const char *parseNumber(const char *cursor, const char *end, T &value) {
+    if (cursor < end && *cursor == '+') {
+        ++cursor;
+    }
+    std::from_chars_result result = std::from_chars(cursor, end, value);
+    if (result.ec != std::errc() || (result.ptr < end && !isSpace(*result.ptr))) {
+        const char *tokenEnd = std::find_if(cursor, end, isSpace);
+        throw std::runtime_error("Invalid number in TXT data: '" +
+                                 std::string(cursor, std::min<std::size_t>(tokenEnd - cursor, 40)) + "'");
+    }
+    return result.ptr;
+}
+
+TxtHeader parseTxtHeader(const char *&cursor, const char *end) {
+    TxtHeader header;
+    try {
+        cursor = parseNumber(skipSpace(cursor, end), end, header.duration);
+        cursor = parseNumber(skipSpace(cursor, end), end, header.sampleRate);
+        cursor = parseNumber(skipSpace(cursor, end), end, header.sampleSize);
+    } catch (const std::runtime_error &) {
+        throw std::runtime_error("Invalid TXT file: missing or malformed header");
+    }
+    return header;
+}
+
+void parseTxtSamples(const char *begin, const char *end, std::size_t count, sample *out) {
+    // Cut the text at whitespace so that no value straddles two chunks
+    std::vector<const char *> bounds{begin};
+    while (bounds.back() < end) {
+        const char *next = bounds.back() + std::min<std::size_t>(parseChunkBytes, end - bounds.back());
+        while (next < end && !isSpace(*next)) {
+            ++next;
+        }
+        bounds.push_back(next);
+    }
+    std::size_t chunks = bounds.size() - 1;
+
+    // First pass: count the values in each chunk to know where each one starts
+    std::vector<std::size_t> firstIndex(chunks + 1, 0);
+    ThreadPool::getInstance().parallelFor(0, chunks, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t chunk = first; chunk < last; ++chunk) {
+            std::size_t values = 0;
+            bool inValue = false;
+            for (const char *p = bounds[chunk]; p < bounds[chunk + 1]; ++p) {
+                bool space = isSpace(*p);
+                values += (!space && !inValue);
+                inValue = !space;
+            }
+            firstIndex[chunk + 1] = values;
+        }
+    });
+    for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+        firstIndex[chunk + 1] += firstIndex[chunk];
+    }
+    if (firstIndex[chunks] < count) {
+        throw std::runtime_error("Failed to read sample data or unexpected end of file: expected " +
+                                 std::to_string(count) + " samples, found " + std::to_string(firstIndex[chunks]));
+    }
+
+    // Second pass: parse every chunk straight into its place
+    ThreadPool::getInstance().parallelFor(0, chunks, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t chunk = first; chunk < last; ++chunk) {
+            const char *cursor = bounds[chunk];
+            const char *chunkEnd = bounds[chunk + 1];
+            for (std::size_t index = firstIndex[chunk]; index < std::min(count, firstIndex[chunk + 1]); ++index) {
+                cursor = parseNumber(skipSpace(cursor, chunkEnd), chunkEnd, out[index]);
+            }
+        }
+    });
+}
+
+// Appends the shortest text that reads back to exactly `value`
+template<typename T>
+static void appendNumber(std::string &text, T value) {
+    char buffer[maxNumberChars];
+    std::to_chars_result result = std::to_chars(buffer, buffer + maxNumberChars, value);
+    text.append(buffer, result.ptr);
+}
+
+void writeTxtHeader(std::ostream &out, const TxtHeader &header, char separator, char terminator) {
+    std::string text;
+    appendNumber(text, header.duration);
+    text += separator;
+    appendNumber(text, header.sampleRate);
+    text += separator;
+    appendNumber(text, header.sampleSize);
+    text += terminator;
+    out.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+void writeTxtSamples(std::ostream &out, const sample *const *planes, unsigned channels, std::size_t count,
+                     bool trailingSeparator) {
+    ThreadPool &pool = ThreadPool::getInstance();
+    std::size_t chunksPerWindow = pool.getThreadCount() + 1; // Workers plus the calling thread
+    std::vector<std::string> pieces(chunksPerWindow);
+    std::size_t windowFrames = chunksPerWindow * formatChunkFrames;
+
+    for (std::size_t window = 0; window < count; window += windowFrames) {
+        std::size_t windowEnd = std::min(count, window + windowFrames);
+        pool.parallelFor(window, windowEnd, formatChunkFrames, [&](std::size_t first, std::size_t last) {
+            std::string &text = pieces[(first - window) / formatChunkFrames];
+            text.clear();
+            text.reserve((last - first) * channels * (maxNumberChars / 2));
+            for (std::size_t i = first; i < last; ++i) {
+                for (unsigned c = 0; c < channels; ++c) { // Frames are written interleaved
+                    appendNumber(text, planes[c][i]);
+                    text += ' ';
+                }
+            }
+            if (last == count && !trailingSeparator && !text.empty()) {
+                text.pop_back();
+            }
+        });
+        for (std::size_t chunk = 0; window + chunk * formatChunkFrames < windowEnd; ++chunk) {
+            out.write(pieces[chunk].data(), static_cast<std::streamsize>(pieces[chunk].size()));
+        }
+        if (!out) {
+            throw std::runtime_error("Failed to write TXT sample data");
+        }
+    }
+}
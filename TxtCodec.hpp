@@ -0,0 +1,72 @@
+/**
+ * @file TxtCodec.hpp
+ * @brief Declares the fast reader and writer for the whitespace-separated TXT sample format.
+ */
+
+#ifndef DAW_TXTCODEC_HPP
+#define DAW_TXTCODEC_HPP
+
+#include "Audio.hpp" // For the sample type
+#include <cstddef>
+#include <ostream>
+
+/**
+ * @brief The header line of a TXT sample file: duration, sample rate and sample count.
+ */
+struct TxtHeader {
+    double duration = 0.0;      ///< Duration in seconds.
+    double sampleRate = 0.0;    ///< Sample rate in Hz.
+    std::size_t sampleSize = 0; ///< Number of samples that follow.
+};
+
+/**
+ * @brief Parses the TXT header and advances the cursor past it.
+ *
+ * Numbers are read with `std::from_chars`, so parsing does not depend on the locale.
+ * @param cursor The start of the text; moved to just after the header on return.
+ * @param end One past the last character of the text.
+ * @return The parsed header.
+ * @throws std::runtime_error if the header is missing or malformed.
+ */
+TxtHeader parseTxtHeader(const char *&cursor, const char *end);
+
+/**
+ * @brief Parses whitespace-separated sample values in parallel.
+ *
+ * The text is cut into large chunks at whitespace, the values in each chunk are counted
+ * and then parsed with `std::from_chars` straight into their place, both on the shared
+ * `ThreadPool`. Values after the first `count` are ignored.
+ * @param begin The start of the sample text.
+ * @param end One past the last character.
+ * @param count The number of samples to read.
+ * @param out Destination for `count` samples.
+ * @throws std::runtime_error if a value is malformed or there are fewer than `count` values.
+ */
+void parseTxtSamples(const char *begin, const char *end, std::size_t count, sample *out);
+
+/**
+ * @brief Writes a TXT header as three numbers, each followed by `separator` except the last.
+ * @param out The destination stream.
+ * @param header The header to write.
+ * @param separator The character between the numbers.
+ * @param terminator The character after the last number.
+ */
+void writeTxtHeader(std::ostream &out, const TxtHeader &header, char separator, char terminator);
+
+/**
+ * @brief Writes samples as space-separated text that reads back to the identical values.
+ *
+ * Values are formatted with `std::to_chars` in their shortest round-trip form. Blocks of frames
+ * are formatted in parallel into per-chunk buffers and written in order, so memory stays bounded.
+ * Frames of several channels are written interleaved.
+ * @param out The destination stream.
+ * @param planes One plane per channel.
+ * @param channels The number of planes.
+ * @param count The number of samples per plane.
+ * @param trailingSeparator Whether the last value is followed by a space as well.
+ * @throws std::runtime_error if writing fails.
+ */
+void writeTxtSamples(std::ostream &out, const sample *const *planes, unsigned channels, std::size_t count,
+                     bool trailingSeparator);
+
+#endif //DAW_TXTCODEC_HPP
@@ -0,0 +1,239 @@
+#include "WavFormat.hpp"
+#include "Kernels.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/// Bytes read from the data chunk per call; large enough to keep reads disk bound
+static constexpr std::size_t readBlockBytes = 1 << 20;
+
+// Helper function to read little-endian integers
+static std::uint32_t readLEint(std::istream &stream, int size) {
+    std::uint32_t value = 0;
+    char byte;
+    for (int i = 0; i < size; ++i) {
+        stream.get(byte);
+        if (stream.fail()) {
+            throw std::runtime_error("Failed to read integer from stream or unexpected end of file");
+        }
+        value |= static_cast<std::uint32_t>(static_cast<unsigned char>(byte)) << (i * 8);
+    }
+    return value;
+}
+
+// Skips bytes on any stream, seekable or not
+static void skipBytes(std::istream &stream, std::uint64_t count) {
+    stream.ignore(static_cast<std::streamsize>(count));
+    if (stream.fail()) {
+        throw std::runtime_error("Failed to skip chunk during WAV parse.");
+    }
+}
+
+std::size_t WavFormat::frameCount() const {
+    return blockAlign > 0 ? static_cast<std::size_t>(dataSize / blockAlign) : 0;
+}
+
+WavFormat readWavHeader(std::istream &in) {
+    char chunkID[4];
+    // Read RIFF chunk descriptor
+    in.read(chunkID, 4);
+    if (in.gcount() < 4 || std::string(chunkID, 4) != "RIFF") {
+        throw std::runtime_error("Invalid WAV file: Missing RIFF chunk");
+    }
+    readLEint(in, 4); // chunkSize
+    in.read(chunkID, 4);
+    if (in.gcount() < 4 || std::string(chunkID, 4) != "WAVE") {
+        throw std::runtime_error("Invalid WAV file: Missing WAVE format");
+    }
+
+    WavFormat format;
+    bool fmtFound = false;
+    std::uint64_t position = 12;
+    while (true) {
+        in.read(chunkID, 4);
+        if (in.gcount() < 4) {
+            break;
+        }
+        std::uint32_t chunkSize = readLEint(in, 4);
+        std::uint64_t padding = chunkSize & 1u; // Chunks are word aligned
+        position += 8;
+        std::string id(chunkID, 4);
+
+        if (id == "fmt ") {
+            if (chunkSize < 16) {
+                throw std::runtime_error("Invalid WAV file: fmt sub-chunk is too small");
+            }
+            std::uint32_t formatTag = readLEint(in, 2);
+            format.channels = readLEint(in, 2);
+            format.sampleRate = readLEint(in, 4);
+            /*byteRate =*/ readLEint(in, 4);
+            /*blockAlign =*/ readLEint(in, 2); // Recomputed below, some writers get it wrong
+            format.bitsPerSample = readLEint(in, 2);
+            std::uint32_t consumed = 16;
+            if (formatTag == 0xFFFE && chunkSize >= 40) { // WAVE_FORMAT_EXTENSIBLE
+                /*cbSize =*/ readLEint(in, 2);
+                /*validBitsPerSample =*/ readLEint(in, 2);
+                /*channelMask =*/ readLEint(in, 4);
+                formatTag = readLEint(in, 2); // The SubFormat GUID starts with the real format tag
+                consumed = 26;
+            }
+            skipBytes(in, chunkSize - consumed + padding);
+
+            if (formatTag == 1) {
+                format.encoding = WavEncoding::PCM;
+            } else if (formatTag == 3) {
+                format.encoding = WavEncoding::Float;
+            } else {
+                throw std::runtime_error("Unsupported WAV format tag: " + std::to_string(formatTag));
+            }
+            fmtFound = true;
+        } else if (id == "data") {
+            if (!fmtFound) {
+                throw std::runtime_error("Invalid WAV file: data sub-chunk before fmt sub-chunk");
+            }
+            format.dataOffset = position;
+            format.dataSize = chunkSize;
+
+            // Streamed files may declare a bogus size; trust the actual file length when we can see it
+            std::streampos here = in.tellg();
+            if (here != std::streampos(-1)) {
+                in.seekg(0, std::ios::end);
+                std::streampos end = in.tellg();
+                in.seekg(here);
+                if (end != std::streampos(-1) && end >= here) {
+                    format.dataSize = std::min<std::uint64_t>(format.dataSize, static_cast<std::uint64_t>(end - here));
+                }
+            }
+            break;
+        } else {
+            skipBytes(in, chunkSize + padding); // Skip unknown chunks
+        }
+        position += chunkSize + padding;
+    }
+
+    if (!fmtFound) {
+        throw std::runtime_error("Invalid WAV file: Missing fmt sub-chunk");
+    }
+    if (format.dataOffset == 0) {
+        throw std::runtime_error("Invalid WAV file: Missing data sub-chunk or read error before finding it.");
+    }
+    if (format.channels == 0 || format.sampleRate == 0) {
+        throw std::runtime_error("Invalid WAV file: zero channels or sample rate");
+    }
+    bool supported = (format.encoding == WavEncoding::PCM)
+                     ? (format.bitsPerSample == 8 || format.bitsPerSample == 16 ||
+                        format.bitsPerSample == 24 || format.bitsPerSample == 32)
+                     : (format.bitsPerSample == 32 || format.bitsPerSample == 64);
+    if (!supported) {
+        throw std::runtime_error("Unsupported WAV format: " + std::to_string(format.bitsPerSample) + "-bit " +
+                                 (format.encoding == WavEncoding::PCM ? "PCM" : "float"));
+    }
+    format.blockAlign = format.channels * (format.bitsPerSample / 8);
+    return format;
+}
+
+void convertWavSamples(const WavFormat &format, const unsigned char *bytes, std::size_t count, sample *out) {
+    const KernelSet &kernels = activeKernels();
+    if (format.encoding == WavEncoding::Float) {
+        if (format.bitsPerSample == 32) {
+            if constexpr (sizeof(sample) == sizeof(float)) {
+                std::memcpy(out, bytes, count * sizeof(float));
+            } else {
+                for (std::size_t k = 0; k < count; ++k) {
+                    float value;
+                    std::memcpy(&value, bytes + k * 4, 4);
+                    out[k] = static_cast<sample>(value);
+                }
+            }
+        } else {
+            for (std::size_t k = 0; k < count; ++k) {
+                double value;
+                std::memcpy(&value, bytes + k * 8, 8);
+                out[k] = static_cast<sample>(value);
+            }
+        }
+        return;
+    }
+
+    switch (format.bitsPerSample) {
+        case 8: // Unsigned, centered on 128
+            for (std::size_t k = 0; k < count; ++k) {
+                out[k] = (static_cast<sample>(bytes[k]) - sample(128)) * (sample(1) / sample(128));
+            }
+            break;
+        case 16:
+            kernels.int16ToSample(bytes, count, out);
+            break;
+        case 24: {
+            // Widen to the top of an int32 in small batches, then use the int32 kernel
+            constexpr std::size_t batch = 1024;
+            std::int32_t widened[batch];
+            for (std::size_t pos = 0; pos < count; pos += batch) {
+                std::size_t n = std::min(batch, count - pos);
+                const unsigned char *src = bytes + pos * 3;
+                for (std::size_t k = 0; k < n; ++k) {
+                    widened[k] = static_cast<std::int32_t>(static_cast<std::uint32_t>(src[3 * k]) << 8 |
+                                                           static_cast<std::uint32_t>(src[3 * k + 1]) << 16 |
+                                                           static_cast<std::uint32_t>(src[3 * k + 2]) << 24);
+                }
+                kernels.int32ToSample(reinterpret_cast<const unsigned char *>(widened), n, out + pos);
+            }
+            break;
+        }
+        case 32:
+            kernels.int32ToSample(bytes, count, out);
+            break;
+        default:
+            throw std::runtime_error("Unsupported WAV format: " + std::to_string(format.bitsPerSample) + "-bit PCM");
+    }
+}
+
+void decodeWavFrames(const WavFormat &format, const unsigned char *bytes, std::size_t frames, sample *const *planes) {
+    if (format.channels == 1) {
+        convertWavSamples(format, bytes, frames, planes[0]);
+        return;
+    }
+    // Convert a cache-sized run of interleaved samples, then scatter it to the planes
+    constexpr std::size_t scratchSamples = 4096;
+    sample scratch[scratchSamples];
+    std::vector<sample> wideScratch; // Only for frames wider than the stack scratch
+    sample *interleaved = scratch;
+    if (format.channels > scratchSamples) {
+        wideScratch.resize(format.channels);
+        interleaved = wideScratch.data();
+    }
+    std::size_t framesPerRun = std::max<std::size_t>(1, scratchSamples / format.channels);
+    for (std::size_t pos = 0; pos < frames; pos += framesPerRun) {
+        std::size_t n = std::min(framesPerRun, frames - pos);
+        convertWavSamples(format, bytes + pos * format.blockAlign, n * format.channels, interleaved);
+        for (unsigned c = 0; c < format.channels; ++c) {
+            sample *plane = planes[c] + pos;
+            const sample *source = interleaved + c;
+            for (std::size_t f = 0; f < n; ++f) {
+                plane[f] = source[f * format.channels];
+            }
+        }
+    }
+}
+
+void readWavData(std::istream &in, const WavFormat &format, sample *const *planes) {
+    std::size_t frames = format.frameCount();
+    std::size_t framesPerBlock = std::max<std::size_t>(1, readBlockBytes / format.blockAlign);
+    std::vector<unsigned char> bytes(framesPerBlock * format.blockAlign);
+    std::vector<sample *> block(format.channels);
+
+    for (std::size_t pos = 0; pos < frames; pos += framesPerBlock) {
+        std::size_t n = std::min(framesPerBlock, frames - pos);
+        std::size_t byteCount = n * format.blockAlign;
+        in.read(reinterpret_cast<char *>(bytes.data()), static_cast<std::streamsize>(byteCount));
+        if (static_cast<std::size_t>(in.gcount()) < byteCount) {
+            throw std::runtime_error("Failed to read sample data or unexpected end of file");
+        }
+        for (unsigned c = 0; c < format.channels; ++c) {
+            block[c] = planes[c] + pos;
+        }
+        decodeWavFrames(format, bytes.data(), n, block.data());
+    }
+}
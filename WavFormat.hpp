@@ -0,0 +1,84 @@
+/**
+ * @file WavFormat.hpp
+ * @brief Defines the WAV header description and the bulk WAV sample decoder.
+ */
+
+#ifndef DAW_WAVFORMAT_HPP
+#define DAW_WAVFORMAT_HPP
+
+#include "Audio.hpp" // For the sample type
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+
+/**
+ * @brief How the samples in a WAV data chunk are encoded.
+ */
+enum class WavEncoding {
+    PCM,  ///< Integer PCM: 8-bit unsigned, or 16/24/32-bit signed.
+    Float ///< IEEE float, 32 or 64 bits.
+};
+
+/**
+ * @brief The format of a WAV file, as read from its header.
+ */
+struct WavFormat {
+    WavEncoding encoding = WavEncoding::PCM; ///< Sample encoding, resolved through WAVE_FORMAT_EXTENSIBLE if present.
+    unsigned channels = 0;                   ///< Number of interleaved channels.
+    unsigned sampleRate = 0;                 ///< Frames per second.
+    unsigned bitsPerSample = 0;              ///< Container size of one sample in bits.
+    unsigned blockAlign = 0;                 ///< Bytes per frame (all channels).
+    std::uint64_t dataOffset = 0;            ///< Byte offset of the sample data from the start of the file.
+    std::uint64_t dataSize = 0;              ///< Size of the sample data in bytes.
+
+    /**
+     * @brief Gets the number of complete frames in the data chunk.
+     * @return The number of frames.
+     */
+    std::size_t frameCount() const;
+};
+
+/**
+ * @brief Parses a RIFF/WAVE header and positions the stream at the first sample.
+ *
+ * Accepts 8/16/24/32-bit integer PCM and 32/64-bit IEEE float, either as plain format tags or
+ * through WAVE_FORMAT_EXTENSIBLE. Unknown chunks before and between `fmt ` and `data` are skipped.
+ * A data size that runs past the end of a seekable stream is clamped to what is actually there.
+ * @param in The input stream, positioned at the start of the file.
+ * @return The parsed format.
+ * @throws std::runtime_error if the header is invalid or the format is unsupported.
+ */
+WavFormat readWavHeader(std::istream &in);
+
+/**
+ * @brief Converts interleaved WAV sample data to samples in [-1.0, 1.0).
+ *
+ * Integer formats are scaled by their full-scale value; float formats are copied as they are.
+ * Uses the vectorized conversion kernels for 16-bit, 24-bit and 32-bit data.
+ * WAV data is little-endian; like the rest of the WAV code, this assumes a little-endian host.
+ * @param format The format of the data.
+ * @param bytes The raw sample data.
+ * @param count The number of individual samples (frames times channels) to convert.
+ * @param out The destination, with room for `count` samples.
+ */
+void convertWavSamples(const WavFormat &format, const unsigned char *bytes, std::size_t count, sample *out);
+
+/**
+ * @brief Decodes interleaved frames and deinterleaves them into channel planes.
+ * @param format The format of the data.
+ * @param bytes The raw frames.
+ * @param frames The number of frames to decode.
+ * @param planes One destination plane per channel, each with room for `frames` samples.
+ */
+void decodeWavFrames(const WavFormat &format, const unsigned char *bytes, std::size_t frames, sample *const *planes);
+
+/**
+ * @brief Reads the data chunk in large blocks, decodes it and deinterleaves it into channel planes.
+ * @param in The input stream, positioned at the first sample (as left by `readWavHeader`).
+ * @param format The format of the data.
+ * @param planes One destination plane per channel, each with room for `format.frameCount()` samples.
+ * @throws std::runtime_error if the data ends early.
+ */
+void readWavData(std::istream &in, const WavFormat &format, sample *const *planes);
+
+#endif //DAW_WAVFORMAT_HPP
@@ -0,0 +1,264 @@
+#include "WavWriter.hpp"
+#include "Kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+/// Bytes collected before each write to the stream
+static constexpr std::size_t stagingBytes = 1 << 20;
+
+/// Header size field value for a stream of unknown length
+static constexpr std::uint32_t unknownSize = 0xFFFFFFFF;
+
+// Stores a little-endian integer and advances the cursor
+static void putLE(unsigned char *&cursor, std::uint32_t value, int size) {
+    for (int i = 0; i < size; ++i) {
+        *cursor++ = static_cast<unsigned char>(value >> (i * 8));
+    }
+}
+
+// Integer hash used as a counter-based random generator (lowbias32)
+static std::uint32_t hash32(std::uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+// Fills `out` with triangular noise in (-1, 1) LSB for frames first..first+count of a channel
+static void tpdfNoise(unsigned channel, std::uint64_t first, std::size_t count, sample *out) {
+    const std::uint32_t key = hash32(channel * 0x9E3779B9U + 0x6A09E667U);
+    const std::uint32_t base = static_cast<std::uint32_t>(first);
+    for (std::size_t k = 0; k < count; ++k) {
+        std::uint32_t h = hash32(key ^ (base + static_cast<std::uint32_t>(k)));
+        // The difference of two uniform variables has a triangular distribution
+        out[k] = static_cast<sample>(static_cast<int>(h & 0xFFFF) - static_cast<int>(h >> 16)) * sample(1.0 / 65536);
+    }
+}
+
+WavWriter::WavWriter(std::ostream &out, unsigned channels, unsigned sampleRate, WavEncoding encoding,
+                     unsigned bitsPerSample, WavDither dither, std::uint64_t expectedFrames)
+        : out(out), dither(dither), headerStart(out.tellp()) {
+    bool supported = (encoding == WavEncoding::PCM)
+                     ? (bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32)
+                     : (bitsPerSample == 32);
+    if (!supported) {
+        throw std::invalid_argument("Unsupported WAV output format: " + std::to_string(bitsPerSample) + "-bit " +
+                                    (encoding == WavEncoding::PCM ? "PCM" : "float"));
+    }
+    if (channels == 0 || sampleRate == 0) {
+        throw std::invalid_argument("WAV output requires at least one channel and a sample rate.");
+    }
+    format.encoding = encoding;
+    format.channels = channels;
+    format.sampleRate = sampleRate;
+    format.bitsPerSample = bitsPerSample;
+    format.blockAlign = channels * (bitsPerSample / 8);
+
+    std::size_t framesPerFlush = std::max(Audio::blockSize, stagingBytes / format.blockAlign);
+    staging.resize(framesPerFlush * format.blockAlign);
+    quantized.resize(Audio::blockSize);
+    if (dither != WavDither::None) {
+        noise.resize(Audio::blockSize);
+    }
+    shapingError.assign(2 * channels, sample(0));
+
+    this->writeHeader(expectedFrames > 0 ? expectedFrames * format.blockAlign : unknownSize);
+}
+
+WavWriter::~WavWriter() {
+    if (!finished) {
+        try {
+            this->finish();
+        } catch (...) {
+            // Destructors must not throw; call finish() to see errors
+        }
+    }
+}
+
+void WavWriter::writeHeader(std::uint64_t dataBytes) {
+    // WAVE_FORMAT_EXTENSIBLE is required for more than two channels or more than 16 bits
+    bool extensible = format.channels > 2 || format.bitsPerSample > 16;
+    std::uint32_t fmtSize = extensible ? 40 : 16;
+    std::uint32_t formatTag = (format.encoding == WavEncoding::PCM) ? 1 : 3;
+    std::uint64_t riffSize = 4 + (8 + fmtSize) + 8 + dataBytes + (dataBytes & 1u);
+
+    unsigned char header[68];
+    unsigned char *cursor = header;
+    std::memcpy(cursor, "RIFF", 4);
+    cursor += 4;
+    std::uint64_t riffField = (dataBytes >= unknownSize) ? unknownSize : std::min<std::uint64_t>(riffSize, unknownSize);
+    putLE(cursor, static_cast<std::uint32_t>(riffField), 4);
+    std::memcpy(cursor, "WAVEfmt ", 8);
+    cursor += 8;
+    putLE(cursor, fmtSize, 4);
+    putLE(cursor, extensible ? 0xFFFE : formatTag, 2);
+    putLE(cursor, format.channels, 2);
+    putLE(cursor, format.sampleRate, 4);
+    putLE(cursor, format.sampleRate * format.blockAlign, 4); // byteRate
+    putLE(cursor, format.blockAlign, 2);
+    putLE(cursor, format.bitsPerSample, 2);
+    if (extensible) {
+        putLE(cursor, 22, 2);                   // cbSize
+        putLE(cursor, format.bitsPerSample, 2); // validBitsPerSample
+        putLE(cursor, format.channels == 1 ? 0x4 : (format.channels == 2 ? 0x3 : 0), 4); // channelMask
+        // SubFormat GUID: the format tag followed by the fixed KSDATAFORMAT suffix
+        static const unsigned char guidSuffix[14] = {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80,
+                                                     0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+        putLE(cursor, formatTag, 2);
+        std::memcpy(cursor, guidSuffix, sizeof(guidSuffix));
+        cursor += sizeof(guidSuffix);
+    }
+    std::memcpy(cursor, "data", 4);
+    cursor += 4;
+    putLE(cursor, static_cast<std::uint32_t>(std::min<std::uint64_t>(dataBytes, unknownSize)), 4);
+
+    out.write(reinterpret_cast<const char *>(header), cursor - header);
+    if (out.fail()) {
+        throw std::runtime_error("Failed to write WAV header.");
+    }
+}
+
+void WavWriter::flush() {
+    if (staged > 0) {
+        out.write(reinterpret_cast<const char *>(staging.data()), static_cast<std::streamsize>(staged));
+        staged = 0;
+        if (out.fail()) {
+            throw std::runtime_error("Failed to write WAV sample data.");
+        }
+    }
+}
+
+void WavWriter::quantizeShaped(const sample *in, std::size_t count, unsigned channel, sample scale, sample upper) {
+    const sample lower = -scale;
+    sample e1 = shapingError[2 * channel];
+    sample e2 = shapingError[2 * channel + 1];
+    for (std::size_t k = 0; k < count; ++k) {
+        // Error feedback with noise transfer function (1 - z^-1)^2
+        sample target = in[k] * scale - 2 * e1 + e2;
+        sample v = target + noise[k];
+        v = (v > lower) ? v : lower;
+        v = (v < upper) ? v : upper;
+        sample rounded = std::nearbyint(v);
+        sample error = std::clamp(rounded - target, sample(-2), sample(2)); // Keeps the loop stable when clipping
+        e2 = e1;
+        e1 = error;
+        quantized[k] = static_cast<std::int32_t>(rounded);
+    }
+    shapingError[2 * channel] = e1;
+    shapingError[2 * channel + 1] = e2;
+}
+
+void WavWriter::write(const sample *const *planes, std::size_t frames) {
+    if (finished) {
+        throw std::logic_error("WavWriter::write called after finish().");
+    }
+    const KernelSet &kernels = activeKernels();
+    const unsigned bytesPerSample = format.bitsPerSample / 8;
+    const sample scale = static_cast<sample>(std::ldexp(1.0, static_cast<int>(format.bitsPerSample) - 1));
+    sample upper = scale - 1;
+    if (static_cast<double>(upper) >= static_cast<double>(scale)) {
+        upper = std::nextafter(scale, sample(0)); // 2^31 - 1 is not representable in float
+    }
+
+    for (std::size_t pos = 0; pos < frames; pos += Audio::blockSize) {
+        std::size_t n = std::min(Audio::blockSize, frames - pos);
+        if (staged + n * format.blockAlign > staging.size()) {
+            this->flush();
+        }
+        for (unsigned c = 0; c < format.channels; ++c) {
+            const sample *source = planes[c] + pos;
+            unsigned char *target = staging.data() + staged + c * bytesPerSample;
+            if (format.encoding == WavEncoding::Float) {
+                for (std::size_t f = 0; f < n; ++f) {
+                    float value = static_cast<float>(source[f]);
+                    std::memcpy(target + f * format.blockAlign, &value, 4);
+                }
+                continue;
+            }
+
+            if (dither != WavDither::None) {
+                tpdfNoise(c, framesWritten + pos, n, noise.data());
+            }
+            if (dither == WavDither::NoiseShaped) {
+                this->quantizeShaped(source, n, c, scale, upper);
+            } else {
+                kernels.quantize(source, n, scale, -scale, upper,
+                                 dither == WavDither::TPDF ? noise.data() : nullptr, quantized.data());
+            }
+            // Interleave: the low bytes of each little-endian int32
+            for (std::size_t f = 0; f < n; ++f) {
+                std::memcpy(target + f * format.blockAlign, &quantized[f], bytesPerSample);
+            }
+        }
+        staged += n * format.blockAlign;
+    }
+    framesWritten += frames;
+}
+
+void WavWriter::writeSilence(std::size_t frames) {
+    if (dither != WavDither::None && format.encoding == WavEncoding::PCM) {
+        // Dithered silence is noise, so it goes through the regular encoder
+        std::vector<sample> zeros(std::min(frames, Audio::blockSize), 0.0);
+        std::vector<const sample *> planes(format.channels, zeros.data());
+        for (std::size_t pos = 0; pos < frames; pos += zeros.size()) {
+            this->write(planes.data(), std::min(zeros.size(), frames - pos));
+        }
+        return;
+    }
+    if (finished) {
+        throw std::logic_error("WavWriter::writeSilence called after finish().");
+    }
+    // Silence encodes as all-zero bytes in every supported format
+    for (std::size_t pos = 0; pos < frames;) {
+        std::size_t room = (staging.size() - staged) / format.blockAlign;
+        if (room == 0) {
+            this->flush();
+            continue;
+        }
+        std::size_t n = std::min(room, frames - pos);
+        std::memset(staging.data() + staged, 0, n * format.blockAlign);
+        staged += n * format.blockAlign;
+        pos += n;
+    }
+    framesWritten += frames;
+}
+
+void WavWriter::finish() {
+    if (finished) {
+        return;
+    }
+    finished = true;
+    std::uint64_t dataBytes = framesWritten * format.blockAlign;
+    this->flush();
+    if (dataBytes & 1u) {
+        out.put(0); // Chunks are word aligned
+    }
+
+    if (headerStart != std::streampos(-1)) {
+        std::streampos end = out.tellp();
+        out.seekp(headerStart);
+        if (!out.fail()) {
+            this->writeHeader(dataBytes);
+            out.seekp(end);
+        } else {
+            out.clear(); // Not seekable after all; the header keeps its initial sizes
+        }
+    }
+    out.flush();
+    if (out.fail()) {
+        throw std::runtime_error("Failed to finish WAV file.");
+    }
+}
+
+std::uint64_t WavWriter::getFramesWritten() const {
+    return framesWritten;
+}
+
+unsigned WavWriter::getChannels() const {
+    return format.channels;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file WavWriter.hpp
+ * @brief Defines the WavWriter class, a buffered block encoder for WAV files.
+ */
+
+#ifndef DAW_WAVWRITER_HPP
+#define DAW_WAVWRITER_HPP
+
+#include "Audio.hpp"
+#include "WavFormat.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief How samples are rounded when written as integer PCM.
+ */
+enum class WavDither {
+    None,       ///< Plain rounding to nearest.
+    TPDF,       ///< Triangular (±1 LSB) dither added before rounding, decorrelating the error from the signal.
+    NoiseShaped ///< TPDF dither with second-order error feedback, moving the noise towards high frequencies.
+};
+
+/**
+ * @brief Encodes planar audio into a WAV stream, one block at a time.
+ *
+ * Whole blocks are clamped, scaled, dithered and rounded with the vectorized kernels into a large
+ * staging buffer, which is written to the stream in one call when it fills up. Supports 16/24/32-bit
+ * PCM and 32-bit float. Dither noise is derived from the frame index, so output does not depend on
+ * how the audio is split into `write()` calls.
+ *
+ * The header is written up front. If the stream is seekable, `finish()` patches the sizes; otherwise
+ * the sizes come from the expected length given to the constructor, or are left as the
+ * "unknown length" placeholder 0xFFFFFFFF.
+ */
+class WavWriter {
+private:
+    std::ostream &out;                   ///< The destination stream.
+    WavFormat format;                    ///< The output format.
+    WavDither dither;                    ///< The rounding mode for PCM output.
+    std::streampos headerStart;          ///< Stream position of the RIFF header, or -1 if not seekable.
+    std::vector<unsigned char> staging;  ///< Encoded bytes waiting to be written.
+    std::size_t staged = 0;              ///< Number of valid bytes in `staging`.
+    std::vector<std::int32_t> quantized; ///< Scratch for one quantized plane block.
+    std::vector<sample> noise;           ///< Scratch for one block of dither noise.
+    std::vector<sample> shapingError;    ///< Last two quantization errors per channel, for noise shaping.
+    std::uint64_t framesWritten = 0;     ///< Number of frames encoded so far.
+    bool finished = false;               ///< Whether `finish()` has run.
+
+    /**
+     * @brief Writes the RIFF, fmt and data chunk headers.
+     * @param dataBytes The size of the data chunk, or 0xFFFFFFFF if unknown.
+     */
+    void writeHeader(std::uint64_t dataBytes);
+
+    /**
+     * @brief Writes the staging buffer to the stream.
+     */
+    void flush();
+
+    /**
+     * @brief Quantizes one plane block with noise-shaped dither (sequential error feedback).
+     * @param in The samples to quantize.
+     * @param count The number of samples.
+     * @param channel The channel, selecting the error feedback state.
+     * @param scale The full-scale value, 2^(bits - 1).
+     * @param upper The largest representable output value.
+     */
+    void quantizeShaped(const sample *in, std::size_t count, unsigned channel, sample scale, sample upper);
+
+public:
+    /**
+     * @brief Creates a writer and writes the WAV header.
+     * @param out The destination stream, opened in binary mode.
+     * @param channels The number of channels.
+     * @param sampleRate The sample rate in Hz.
+     * @param encoding PCM or float output.
+     * @param bitsPerSample 16, 24 or 32 for PCM; 32 for float.
+     * @param dither The rounding mode for PCM output (ignored for float).
+     * @param expectedFrames The number of frames that will be written, if known (0 if not).
+     *        Used for the header sizes when the stream cannot be patched afterwards.
+     * @throws std::invalid_argument if the format is not supported.
+     */
+    WavWriter(std::ostream &out, unsigned channels, unsigned sampleRate, WavEncoding encoding = WavEncoding::PCM,
+              unsigned bitsPerSample = 16, WavDither dither = WavDither::None, std::uint64_t expectedFrames = 0);
+
+    WavWriter(const WavWriter &) = delete;
+
+    WavWriter &operator=(const WavWriter &) = delete;
+
+    /**
+     * @brief Finishes the file if `finish()` was not called, ignoring errors.
+     */
+    ~WavWriter();
+
+    /**
+     * @brief Encodes frames from channel planes.
+     * @param planes One plane per channel, each with `frames` samples.
+     * @param frames The number of frames to write.
+     */
+    void write(const sample *const *planes, std::size_t frames);
+
+    /**
+     * @brief Encodes silent frames without reading any samples.
+     *
+     * Undithered silence is written as zero bytes straight into the staging buffer;
+     * with dither the frames still go through the encoder, as dithered silence is noise.
+     * @param frames The number of frames to write.
+     */
+    void writeSilence(std::size_t frames);
+
+    /**
+     * @brief Flushes the remaining data, pads the data chunk and patches the header sizes if possible.
+     * @throws std::runtime_error if writing fails.
+     */
+    void finish();
+
+    /**
+     * @brief Gets the number of frames written so far.
+     * @return The number of frames.
+     */
+    std::uint64_t getFramesWritten() const;
+
+    /**
+     * @brief Gets the number of channels the writer expects.
+     * @return The number of channels.
+     */
+    unsigned getChannels() const;
+};
+
+#endif //DAW_WAVWRITER_HPP
@@ -3,8 +3,213 @@
 #include "Effect.hpp"
 #include "AudioFactory.hpp"
 #include "Generators/Generator.hpp"
+#include "ClipAudio.hpp"
+#include "MappedWavAudio.hpp"
+#include "StreamAudio.hpp"
+#include "StreamRender.hpp"
+#include "BatchRunner.hpp"
+#include "Kernels.hpp"
+#include <cstring>
+#include <memory>
 
-int main() {
+/**
+ * @brief Checks whether a file name ends with an extension.
+ * @param name The file name.
+ * @param extension The extension, including the dot.
+ * @return True if `name` ends with `extension`.
+ */
+static bool hasExtension(const std::string &name, const std::string &extension) {
+    return name.size() > extension.size() && name.compare(name.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+/**
+ * @brief Runs the command-line streaming render: `daw render <input|-> <output|-> [options]`.
+ *
+ * Files are mapped, "-" reads a WAV (or, with `--raw`, headerless samples) from stdin or
+ * writes to stdout. Names ending in ".clip" are read and written in the native clip format
+ * (double precision by default, float with `--float`). Memory use is bounded by one block, whatever the length of the input.
+ * Options: `--raw pcm|float RATE CHANNELS BITS`, `--bits N`, `--float`,
+ * `--dither none|tpdf|shaped`, `--gain FACTOR`.
+ * @param argc The argument count.
+ * @param argv The arguments, starting with the program name.
+ * @return The process exit code.
+ */
+static int runRender(int argc, char **argv) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " render <input.wav|.clip|-> <output.wav|.clip|-> [--raw pcm|float RATE CHANNELS BITS]"
+                  << " [--bits N] [--float] [--dither none|tpdf|shaped] [--gain FACTOR]" << std::endl;
+        return 2;
+    }
+    try {
+        std::string inputName = argv[2];
+        std::string outputName = argv[3];
+        WavEncoding encoding = WavEncoding::PCM;
+        unsigned bits = 16;
+        WavDither dither = WavDither::None;
+        double gain = 1.0;
+        bool raw = false;
+        WavEncoding rawEncoding = WavEncoding::PCM;
+        unsigned rawRate = 0, rawChannels = 0, rawBits = 0;
+
+        for (int i = 4; i < argc; ++i) {
+            std::string option = argv[i];
+            auto next = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument("Missing value for " + option);
+                }
+                return argv[++i];
+            };
+            if (option == "--raw") {
+                raw = true;
+                std::string kind = next();
+                if (kind != "pcm" && kind != "float") {
+                    throw std::invalid_argument("Unknown raw encoding: " + kind);
+                }
+                rawEncoding = (kind == "float") ? WavEncoding::Float : WavEncoding::PCM;
+                rawRate = static_cast<unsigned>(std::stoul(next()));
+                rawChannels = static_cast<unsigned>(std::stoul(next()));
+                rawBits = static_cast<unsigned>(std::stoul(next()));
+            } else if (option == "--bits") {
+                bits = static_cast<unsigned>(std::stoul(next()));
+            } else if (option == "--float") {
+                encoding = WavEncoding::Float;
+                bits = 32;
+            } else if (option == "--dither") {
+                std::string kind = next();
+                if (kind == "none") {
+                    dither = WavDither::None;
+                } else if (kind == "tpdf") {
+                    dither = WavDither::TPDF;
+                } else if (kind == "shaped") {
+                    dither = WavDither::NoiseShaped;
+                } else {
+                    throw std::invalid_argument("Unknown dither: " + kind);
+                }
+            } else if (option == "--gain") {
+                gain = std::stod(next());
+            } else {
+                throw std::invalid_argument("Unknown option: " + option);
+            }
+        }
+
+        std::ios::sync_with_stdio(false);
+        std::shared_ptr<const Audio> source;
+        std::shared_ptr<const StreamAudio> stream;
+        if (inputName == "-") {
+            stream = raw ? std::make_shared<StreamAudio>(std::cin, rawEncoding, rawChannels, rawRate, rawBits)
+                         : std::make_shared<StreamAudio>(std::cin);
+            source = stream;
+        } else if (hasExtension(inputName, ".clip")) {
+            source = std::make_shared<ClipAudio>(inputName.c_str());
+        } else {
+            source = std::make_shared<MappedWavAudio>(inputName.c_str());
+        }
+
+        std::shared_ptr<const Audio> graph = source;
+        if (gain != 1.0) {
+            graph = std::make_shared<Effect<Amplify>>(source, Amplify(gain));
+        }
+
+        std::uint64_t frames;
+        if (hasExtension(outputName, ".clip")) {
+            frames = writeClip(*graph, outputName.c_str(), encoding == WavEncoding::Float ? 4 : sizeof(sample),
+                               stream.get()).frames;
+        } else if (outputName == "-") {
+            frames = streamToWav(*graph, std::cout, encoding, bits, dither, stream.get());
+            std::cout.flush();
+        } else {
+            std::ofstream out(outputName, std::ios::binary);
+            if (!out.is_open()) {
+                throw std::runtime_error("Failed to open file for writing: " + outputName);
+            }
+            frames = streamToWav(*graph, out, encoding, bits, dither, stream.get());
+        }
+        std::cerr << "Rendered " << frames << " frames" << std::endl;
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "Render failed: " << ex.what() << std::endl;
+        return 1;
+    }
+}
+
+/**
+ * @brief Runs a batch script of render jobs in parallel: `daw batch <script|-> [options]`.
+ *
+ * Each script line is an output path followed by an `AudioFactory` command, see `BatchRunner`.
+ * Jobs report as they finish and a failed job does not stop the others.
+ * Options: `--bits N`, `--float`, `--dither none|tpdf|shaped`.
+ * @param argc The argument count.
+ * @param argv The arguments, starting with the program name.
+ * @return 0 if every job succeeded, 1 if any failed, 2 on usage errors.
+ */
+static int runBatch(int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " batch <script|-> [--bits N] [--float] [--dither none|tpdf|shaped]"
+                  << std::endl;
+        return 2;
+    }
+    try {
+        WavEncoding encoding = WavEncoding::PCM;
+        unsigned bits = 16;
+        WavDither dither = WavDither::None;
+        for (int i = 3; i < argc; ++i) {
+            std::string option = argv[i];
+            if (option == "--bits" && i + 1 < argc) {
+                bits = static_cast<unsigned>(std::stoul(argv[++i]));
+            } else if (option == "--float") {
+                encoding = WavEncoding::Float;
+                bits = 32;
+            } else if (option == "--dither" && i + 1 < argc) {
+                std::string kind = argv[++i];
+                if (kind == "none") {
+                    dither = WavDither::None;
+                } else if (kind == "tpdf") {
+                    dither = WavDither::TPDF;
+                } else if (kind == "shaped") {
+                    dither = WavDither::NoiseShaped;
+                } else {
+                    throw std::invalid_argument("Unknown dither: " + kind);
+                }
+            } else {
+                throw std::invalid_argument("Unknown or incomplete option: " + option);
+            }
+        }
+
+        std::vector<BatchJob> jobs;
+        if (std::strcmp(argv[2], "-") == 0) {
+            jobs = BatchRunner::parseScript(std::cin);
+        } else {
+            std::ifstream script(argv[2]);
+            if (!script.is_open()) {
+                throw std::runtime_error(std::string("Failed to open batch script: ") + argv[2]);
+            }
+            jobs = BatchRunner::parseScript(script);
+        }
+        BatchRunner runner(encoding, bits, dither);
+        std::vector<BatchResult> results = runner.run(jobs, &std::cerr);
+        for (const BatchResult &result : results) {
+            if (!result.succeeded) {
+                return 1;
+            }
+        }
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "Batch failed: " << ex.what() << std::endl;
+        return 2;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && std::strcmp(argv[1], "render") == 0) {
+        return runRender(argc, argv);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "batch") == 0) {
+        return runBatch(argc, argv);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "selftest") == 0) {
+        // Every vectorized kernel set must reproduce the scalar reference path
+        return checkKernels(std::cout) ? 0 : 1;
+    }
     try {
         // Create a dummy PESEN.txt, as in the original main
 //        std::ofstream oFile("PESEN.txt");
@@ -47,11 +252,12 @@ int main() {
             std::cout << "\nAudio after FadeIn (ef1):" << std::endl;
 //            ef1.printToStream(std::cout);
 
-            Effect<FadeOut> ef2(&ef1, fadeOutOp);
+            // Chaining with then() fuses the operations into a single Effect type
+            Effect<FadeIn, FadeOut> ef2 = ef1.then(fadeOutOp);
             std::cout << "\nAudio after FadeOut (ef2):" << std::endl;
 //            ef2.printToStream(std::cout);
 
-            Effect<Normalize> efN(&ef2, normalizeOp);
+            Effect<FadeIn, FadeOut, Normalize> efN = ef2.then(normalizeOp);
             std::cout << "\nAudio after Normalize (efN) (normalization based on original file):" << std::endl;
 //            efN.printToStream(std::cout);
 